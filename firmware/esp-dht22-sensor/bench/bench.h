@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal benchmark harness shared by the native (Linux) and on-device builds.
+//
+// Native: wall time from steady_clock, cycles from rdtsc (x86 only), allocations counted by
+//         interposing malloc/free (bench_alloc_native.cpp).
+// Device: cycles from ESP.getCycleCount(); allocations are not hookable, so the heap delta
+//         across the run is reported instead (a non-zero value means the op leaks).
+
+typedef void (*BenchFn)(uint32_t iterations);
+
+struct BenchCase {
+  const char* name;
+  BenchFn fn;
+  uint32_t iterations;
+  BenchCase* next;
+
+  // Filled in by runAllBenchmarks()
+  uint64_t bestNs;
+  uint64_t bestCycles;
+  uint32_t allocs;
+  uint32_t bytes;
+  int32_t heapDelta;
+};
+
+struct BenchRegistrar {
+  BenchRegistrar(BenchCase* bench);
+};
+
+#define BENCHMARK(name, iters)                                                                \
+  static void bench_##name(uint32_t);                                                         \
+  static BenchCase benchCase_##name = { #name, bench_##name, iters, nullptr, 0, 0, 0, 0, 0 }; \
+  static BenchRegistrar benchRegistrar_##name(&benchCase_##name);                             \
+  static void bench_##name(uint32_t iterations)
+
+// Correctness checks run once before the timings. A failing check prints a
+// "# CHECK FAILED" line, which compare.py treats as a regression.
+typedef bool (*BenchCheckFn)(char* detail, size_t cap);
+
+struct BenchCheck {
+  const char* name;
+  BenchCheckFn fn;
+  BenchCheck* next;
+};
+
+struct BenchCheckRegistrar {
+  BenchCheckRegistrar(BenchCheck* check);
+};
+
+#define BENCH_CHECK(name)                                                    \
+  static bool check_##name(char*, size_t);                                   \
+  static BenchCheck benchCheck_##name = { #name, check_##name, nullptr };    \
+  static BenchCheckRegistrar benchCheckRegistrar_##name(&benchCheck_##name); \
+  static bool check_##name(char* detail, size_t detailCap)
+
+// Keeps the optimizer from discarding results
+template <typename T> inline void benchKeep(const T& value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct AllocCounters {
+  uint32_t allocs;
+  uint32_t bytes;
+};
+
+// Implemented per platform
+uint64_t benchNowNs();
+uint64_t benchNowCycles();
+AllocCounters benchAllocCounters();
+int32_t benchFreeHeap();
+
+// Returns the number of failed checks
+int runAllBenchmarks(void (*emit)(const char* line));
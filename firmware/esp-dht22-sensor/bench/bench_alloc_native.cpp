@@ -0,0 +1,59 @@
+// Allocation counting for the native benchmark build.
+// Every malloc-family call made by the code under test, including operator new and
+// ArduinoJson's default allocator, goes through these wrappers. They forward to glibc's
+// __libc_* entry points, so other C libraries (macOS, musl) build without counting and
+// report 0 allocs/bytes; see bench/README.md.
+#ifndef ARDUINO
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+#ifdef __GLIBC__
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static uint32_t allocCount = 0;
+static uint32_t allocBytes = 0;
+
+extern "C" void* malloc(size_t size) {
+  allocCount++;
+  allocBytes += size;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  allocCount++;
+  allocBytes += count * size;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  allocCount++;
+  allocBytes += size;
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+  __libc_free(ptr);
+}
+
+AllocCounters benchAllocCounters() {
+  return { allocCount, allocBytes };
+}
+
+#else
+
+AllocCounters benchAllocCounters() {
+  return { 0, 0 };
+}
+
+#endif  // __GLIBC__
+
+#endif
@@ -0,0 +1,168 @@
+#include "bench.h"
+#include "lzss.h"
+#include "reading_backlog.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static ReadingBacklog benchBacklog;
+static uint8_t chunkBuf[1200];
+static uint8_t scratchBuf[1024];
+
+// A full backlog after an outage: 4 sensors, 10 minute interval, slow drift
+static void fillBacklog() {
+  benchBacklog.setDeviceId("board3");
+  const char* names[] = { "board3-temp", "board3-humidity", "board3-moisture-1", "board3-lux" };
+  uint32_t t = 5000;
+  uint32_t seq = 70000;
+  for (uint16_t c = 0; c < ReadingBacklog::kCapacity / 4; c++) {
+    t += 600000 + (c % 7) * 5;
+    benchBacklog.push(names[0], seq++, t, 21.5f + (c % 11) * 0.1f, NAN);
+    benchBacklog.push(names[1], seq++, t, 45.0f - (c % 5) * 0.3f, NAN);
+    benchBacklog.push(names[2], seq++, t, 16500.0f + (c % 13), 40.0f + (c % 9) * 0.25f);
+    benchBacklog.push(names[3], seq++, t, (c % 144) < 72 ? 220.0f + (c % 17) : 0.0f, NAN);
+  }
+}
+
+// One bulk chunk: delta/varint encode of maxReadingsPerChunk readings plus LZSS compression
+BENCHMARK(backlog_encode_chunk, 200) {
+  if (benchBacklog.empty()) {
+    fillBacklog();
+  }
+  uint16_t covered = 0;
+  for (uint32_t i = 0; i < iterations; i++) {
+    size_t n = benchBacklog.encodeChunk(chunkBuf, sizeof(chunkBuf), scratchBuf, sizeof(scratchBuf), 320000000, 320, covered);
+    benchKeep(n);
+  }
+  benchKeep(covered);
+}
+
+// In-memory stand-in for the LittleFS file main.cpp saves the backlog to
+struct MemoryFile {
+  uint8_t data[ReadingBacklog::kCapacity * 16 + 512];
+  size_t len;
+  size_t pos;
+
+  size_t write(const uint8_t* p, size_t n) {
+    if (len + n > sizeof(data)) {
+      return 0;
+    }
+    memcpy(data + len, p, n);
+    len += n;
+    return n;
+  }
+
+  size_t read(uint8_t* p, size_t n) {
+    size_t left = len - pos;
+    n = n < left ? n : left;
+    memcpy(p, data + pos, n);
+    pos += n;
+    return n;
+  }
+};
+
+struct ChunkReader {
+  const uint8_t* p;
+  const uint8_t* end;
+
+  uint32_t varint() {
+    uint32_t v = 0;
+    for (uint8_t shift = 0; shift < 35 && p < end; shift += 7) {
+      uint8_t b = *p++;
+      v |= static_cast<uint32_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) {
+        break;
+      }
+    }
+    return v;
+  }
+
+  int32_t zigzag() {
+    uint32_t v = varint();
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+  }
+};
+
+static MemoryFile saveFile;
+static ReadingBacklog savedBacklog;
+static ReadingBacklog restoredBacklog;
+static uint8_t checkBody[1024];
+
+// Saved before a restart, restored near the top of millis(), then more readings across the
+// wrap: decoded ages must match what was pushed (the decoder is backlogCodec.ts)
+BENCH_CHECK(backlog_ages_across_restore_and_wrap) {
+  const uint32_t expectedAgesSec[] = { 1500, 900, 300, 240, 120, 1 };
+  const uint8_t total = sizeof(expectedAgesSec) / sizeof(expectedAgesSec[0]);
+
+  // Before the restart: three readings, saved 10 s after the newest
+  uint32_t before = 3000000;
+  for (uint8_t i = 0; i < 3; i++) {
+    savedBacklog.push("board3-temp", 100 + i, before - expectedAgesSec[i] * 1000, 20.0f + i, NAN);
+  }
+  saveFile.len = 0;
+  saveFile.pos = 0;
+  if (!savedBacklog.save(saveFile, before)) {
+    snprintf(detail, detailCap, "save failed");
+    return false;
+  }
+
+  // After the restart millis() is about to wrap; the encode happens after it did
+  uint32_t nowMs = 20000;
+  uint32_t restoreAt = nowMs - 400000;  // 0xFFFA...
+  if (!restoredBacklog.restore(saveFile, restoreAt) || restoredBacklog.size() != 3) {
+    snprintf(detail, detailCap, "restore failed");
+    return false;
+  }
+  for (uint8_t i = 3; i < total; i++) {
+    restoredBacklog.push("board3-temp", 100 + i, nowMs - expectedAgesSec[i] * 1000, 20.0f + i, NAN);
+  }
+
+  static uint8_t chunk[1200];
+  uint16_t covered = 0;
+  size_t len = restoredBacklog.encodeChunk(chunk, sizeof(chunk), checkBody, sizeof(checkBody), nowMs, 320, covered);
+  if (len == 0 || covered != total) {
+    snprintf(detail, detailCap, "encode failed");
+    return false;
+  }
+
+  // Ages before the restart grew by the 400 s between save and restore
+  size_t rawLen = chunk[14] | (chunk[15] << 8);
+  const uint8_t* body = chunk + ReadingBacklog::kHeaderSize;
+  if (chunk[3] & 0x01) {
+    if (lzssDecompress(body, len - ReadingBacklog::kHeaderSize, checkBody, sizeof(checkBody)) != rawLen) {
+      snprintf(detail, detailCap, "decompress failed");
+      return false;
+    }
+    body = checkBody;
+  }
+
+  ChunkReader r = { body, body + rawLen };
+  r.p += r.varint();  // device id
+  if (r.varint() != 1) {
+    snprintf(detail, detailCap, "expected one sensor block");
+    return false;
+  }
+  r.p += r.varint();  // name
+  if (r.varint() != total) {
+    snprintf(detail, detailCap, "wrong reading count");
+    return false;
+  }
+  r.p++;  // flags
+
+  int64_t age = r.varint();
+  int32_t delta = 0;
+  for (uint8_t i = 0; i < total; i++) {
+    if (i > 0) {
+      delta += r.zigzag();
+      age -= delta;
+    }
+    uint32_t expected = expectedAgesSec[i] + (i < 3 ? 400 : 0);
+    if (age != expected) {
+      snprintf(detail, detailCap, "reading %u: age %lld s, expected %lu s", i, static_cast<long long>(age),
+        static_cast<unsigned long>(expected));
+      return false;
+    }
+  }
+  return true;
+}
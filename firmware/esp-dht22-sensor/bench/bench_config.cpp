@@ -0,0 +1,33 @@
+#include "bench.h"
+#include "device_config.h"
+
+#include <string.h>
+
+// Shape of a real api/admin/device-configs?deviceId=... response
+static const char sampleConfigBody[] =
+  "{\"success\":true,\"value\":{\"data\":[{\"id\":3,\"device_id\":\"board3\","
+  "\"config\":{\"defaultEnv\":\"prod\",\"environments\":{"
+  "\"prod\":{\"ip\":\"192.168.1.10\",\"port\":3000},"
+  "\"dev\":{\"ip\":\"192.168.1.20\",\"port\":3006}},"
+  "\"intervals\":{\"sendIntervalMs\":300000,\"probeIntervalMs\":120000}},"
+  "\"created_at\":\"2025-05-14T06:36:18.422Z\",\"updated_at\":\"2025-05-14T06:36:18.422Z\"}]},"
+  "\"status\":200}";
+
+BENCHMARK(parse_device_config, 5000) {
+  size_t len = strlen(sampleConfigBody);
+  for (uint32_t i = 0; i < iterations; i++) {
+    DeviceConfig config;
+    ConfigParseResult result = parseDeviceConfig(sampleConfigBody, len, config);
+    benchKeep(result);
+  }
+}
+
+// Runs on every config revalidation: defaults, overrides and clamping
+BENCHMARK(bound_device_intervals, 200000) {
+  DeviceIntervals fallback = defaultDeviceIntervals();
+  for (uint32_t i = 0; i < iterations; i++) {
+    DeviceIntervals requested = { 300000 + (i & 0xFF), 0, 1000, 0, 60000, 0, 0 };
+    benchKeep(boundDeviceIntervals(requested, fallback));
+    benchKeep(requested.maxNoPostMs);
+  }
+}
@@ -0,0 +1,15 @@
+#include "bench.h"
+#include "http_endpoint.h"
+
+// Per-POST cost of the hand-built request: head for a reading upload plus the status line parse
+BENCHMARK(http_request_head, 50000) {
+  HttpUrl url;
+  parseHttpUrl("http://app.nudrasil.com/", url);
+
+  char head[256];
+  for (uint32_t i = 0; i < iterations; i++) {
+    size_t n = buildRequestHead(head, sizeof(head), "POST", url, "api/sensor", "device-secret", "application/json", 96);
+    benchKeep(n);
+    benchKeep(parseStatusLine("HTTP/1.1 201 Created\r"));
+  }
+}
@@ -0,0 +1,81 @@
+#include "bench.h"
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+uint64_t benchNowNs() {
+  return static_cast<uint64_t>(micros()) * 1000ULL;
+}
+
+uint64_t benchNowCycles() {
+  // 32-bit counter wraps every ~26 s at 160 MHz; keep per-case runs shorter than that
+  static uint32_t last = 0;
+  static uint64_t high = 0;
+  uint32_t now = ESP.getCycleCount();
+  if (now < last) {
+    high += 1ULL << 32;
+  }
+  last = now;
+  return high | now;
+}
+
+AllocCounters benchAllocCounters() {
+  return { 0, 0 };
+}
+
+int32_t benchFreeHeap() {
+  return static_cast<int32_t>(ESP.getFreeHeap());
+}
+
+static void emitSerial(const char* line) {
+  Serial.println(line);
+  yield();
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+  Serial.printf("# device bench, cpu %lu MHz\n", static_cast<unsigned long>(ESP.getCpuFreqMHz()));
+  runAllBenchmarks(emitSerial);
+  Serial.println("# done");
+}
+
+void loop() {
+  delay(1000);
+}
+
+#else
+
+#include <chrono>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+uint64_t benchNowNs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t benchNowCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+int32_t benchFreeHeap() {
+  return 0;
+}
+
+static void emitStdout(const char* line) {
+  puts(line);
+}
+
+int main() {
+  return runAllBenchmarks(emitStdout) == 0 ? 0 : 1;
+}
+
+#endif
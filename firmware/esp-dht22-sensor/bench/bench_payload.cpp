@@ -0,0 +1,10 @@
+#include "bench.h"
+#include "reading_payload.h"
+
+BENCHMARK(build_reading_payload, 20000) {
+  char payload[160];
+  for (uint32_t i = 0; i < iterations; i++) {
+    size_t n = buildReadingPayload(payload, sizeof(payload), "board3-moisture-1", 412.0f + (i & 7), NAN, "board3", 70000 + i);
+    benchKeep(n);
+  }
+}
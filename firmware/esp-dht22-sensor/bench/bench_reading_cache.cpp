@@ -0,0 +1,31 @@
+#include "bench.h"
+#include "reading_cache.h"
+
+static ReadingCache benchCache;
+
+BENCHMARK(reading_cache_record, 100000) {
+  for (uint32_t i = 0; i < iterations; i++) {
+    benchCache.record((i & 1) ? "board3-temp" : "board3-humidity", i * 1000, 21.5f);
+  }
+  benchKeep(benchCache);
+}
+
+// Full /readings response (every sensor ring full) in 256-byte pages
+BENCHMARK(reading_cache_format_all, 2000) {
+  static const char* names[] = { "temp", "humidity", "moisture-1", "moisture-2", "moisture-3", "lux" };
+  ReadingCache cache;
+  for (uint32_t i = 0; i < 6 * ReadingCache::kDepth; i++) {
+    cache.record(names[i % 6], i * 1000, 400.0f + i);
+  }
+
+  char page[256];
+  for (uint32_t i = 0; i < iterations; i++) {
+    ReadingCacheCursor cursor;
+    size_t total = 0;
+    size_t n;
+    while ((n = cache.formatReadings(page, sizeof(page), 0, 1000000, cursor)) > 0) {
+      total += n;
+    }
+    benchKeep(total);
+  }
+}
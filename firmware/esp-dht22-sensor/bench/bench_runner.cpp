@@ -0,0 +1,97 @@
+#include "bench.h"
+
+#include <stdio.h>
+
+static BenchCase* benchHead = nullptr;
+static BenchCase* benchTail = nullptr;
+static BenchCheck* checkHead = nullptr;
+static BenchCheck* checkTail = nullptr;
+
+// Every case is timed once per round and its fastest round is reported
+static const uint8_t kBenchRounds = 9;
+
+BenchRegistrar::BenchRegistrar(BenchCase* bench) {
+  // Keep registration order so output lines up with the baseline file
+  if (benchTail) {
+    benchTail->next = bench;
+  } else {
+    benchHead = bench;
+  }
+  benchTail = bench;
+}
+
+BenchCheckRegistrar::BenchCheckRegistrar(BenchCheck* check) {
+  if (checkTail) {
+    checkTail->next = check;
+  } else {
+    checkHead = check;
+  }
+  checkTail = check;
+}
+
+int runAllBenchmarks(void (*emit)(const char* line)) {
+  char line[160];
+  int failed = 0;
+
+  for (BenchCheck* c = checkHead; c != nullptr; c = c->next) {
+    char detail[96] = "";
+    bool ok = c->fn(detail, sizeof(detail));
+    snprintf(line, sizeof(line), ok ? "# check %s ok" : "# CHECK FAILED %s: %s", c->name, detail);
+    emit(line);
+    failed += ok ? 0 : 1;
+  }
+
+  emit("name,iterations,ns_per_op,cycles_per_op,allocs_per_op,bytes_per_op,heap_delta");
+
+  // Warm-up pass so first-touch costs don't land in the measurement
+  for (BenchCase* b = benchHead; b != nullptr; b = b->next) {
+    b->fn(b->iterations / 10 + 1);
+    b->bestNs = UINT64_MAX;
+    b->bestCycles = UINT64_MAX;
+    b->allocs = 0;
+    b->bytes = 0;
+    b->heapDelta = 0;
+  }
+
+  // Rounds over the whole suite, keeping each case's fastest run: preemption and frequency
+  // changes only ever add time, and a slow stretch of the host can't cover every round
+  for (uint8_t round = 0; round < kBenchRounds; round++) {
+    for (BenchCase* b = benchHead; b != nullptr; b = b->next) {
+      int32_t heapBefore = benchFreeHeap();
+      AllocCounters allocBefore = benchAllocCounters();
+      uint64_t cyclesBefore = benchNowCycles();
+      uint64_t nsBefore = benchNowNs();
+
+      b->fn(b->iterations);
+
+      uint64_t ns = benchNowNs() - nsBefore;
+      uint64_t cycles = benchNowCycles() - cyclesBefore;
+      AllocCounters allocAfter = benchAllocCounters();
+      int32_t heapAfter = benchFreeHeap();
+
+      b->bestNs = ns < b->bestNs ? ns : b->bestNs;
+      b->bestCycles = cycles < b->bestCycles ? cycles : b->bestCycles;
+      // Allocations don't depend on timing; keep the worst round
+      uint32_t allocs = allocAfter.allocs - allocBefore.allocs;
+      uint32_t bytes = allocAfter.bytes - allocBefore.bytes;
+      b->allocs = allocs > b->allocs ? allocs : b->allocs;
+      b->bytes = bytes > b->bytes ? bytes : b->bytes;
+      b->heapDelta = (heapBefore - heapAfter) > b->heapDelta ? (heapBefore - heapAfter) : b->heapDelta;
+    }
+  }
+
+  for (BenchCase* b = benchHead; b != nullptr; b = b->next) {
+    double n = static_cast<double>(b->iterations);
+    snprintf(line, sizeof(line), "%s,%lu,%.1f,%.1f,%.2f,%.1f,%ld",
+      b->name,
+      static_cast<unsigned long>(b->iterations),
+      static_cast<double>(b->bestNs) / n,
+      static_cast<double>(b->bestCycles) / n,
+      static_cast<double>(b->allocs) / n,
+      static_cast<double>(b->bytes) / n,
+      static_cast<long>(b->heapDelta));
+    emit(line);
+  }
+
+  return failed;
+}
@@ -0,0 +1,24 @@
+#include "bench.h"
+#include "task_scheduler.h"
+
+static uint32_t schedulerRuns = 0;
+static void countRun() { schedulerRuns++; }
+
+// One loop() pass with the production task mix: run whatever is due, then compute the wait
+BENCHMARK(scheduler_loop_pass, 100000) {
+  TaskScheduler scheduler;
+  const uint32_t intervals[] = { 600000, 10000, 60000, 0, 21600000, 0, 0, 0 };
+  for (uint8_t i = 0; i < 8; i++) {
+    uint8_t id = scheduler.add("task", countRun, intervals[i]);
+    scheduler.schedule(id, 0, intervals[i] ? intervals[i] : 900000 + i);
+  }
+
+  uint32_t now = 0;
+  for (uint32_t i = 0; i < iterations; i++) {
+    now += 50;
+    scheduler.runDue(now);
+    uint32_t waitMs = scheduler.msUntilNext(now, 50);
+    benchKeep(waitMs);
+  }
+  benchKeep(schedulerRuns);
+}
@@ -0,0 +1,57 @@
+#include "bench.h"
+#include "sensor_math.h"
+
+#include <math.h>
+#include <stdio.h>
+
+BENCHMARK(sensor_conversions, 200000) {
+  for (uint32_t i = 0; i < iterations; i++) {
+    int light = luxToReading(static_cast<float>(i & 1023) * 1.5f);
+    float moisture = moistureCountsToValue(256 + static_cast<int>(i & 511));
+    bool valid = isValidReading(moisture);
+    benchKeep(light);
+    benchKeep(valid);
+  }
+}
+
+BENCHMARK(moisture_calibration, 200000) {
+  CalibrationCurve curve;
+  const float counts[] = { 256.0f, 400.0f, 578.0f };
+  const float percents[] = { 100.0f, 60.0f, 0.0f };
+  buildCalibrationCurve(curve, counts, percents, 3);
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    int percent = moistureQ8ToPercent(countsToMoistureQ8(curve, 200 + static_cast<int32_t>(i & 511)));
+    benchKeep(percent);
+  }
+}
+
+// Same as calculateMoisturePercent() in nudrasil-app/src/utils/sensorUtils.ts (Math.round
+// rounds halves up), so firmware-calibrated values match what the dashboard computes
+static int dashboardMoisturePercent(double raw, double soilMin, double soilMax) {
+  double clamped = fmax(fmin(raw, soilMax), soilMin);
+  return static_cast<int>(floor(((soilMax - clamped) * 100.0) / (soilMax - soilMin) + 0.5));
+}
+
+BENCH_CHECK(moisture_matches_dashboard) {
+  for (int32_t wet = 0; wet < 900; wet += 23) {
+    for (int32_t dry = wet + 1; dry <= 900; dry += 17) {
+      CalibrationCurve curve;
+      if (!buildTwoPointCurve(curve, static_cast<float>(wet), static_cast<float>(dry))) {
+        snprintf(detail, detailCap, "curve %ld..%ld rejected", static_cast<long>(wet), static_cast<long>(dry));
+        return false;
+      }
+
+      for (int32_t counts = 0; counts <= 900; counts++) {
+        int expected = dashboardMoisturePercent(counts, wet, dry);
+        int actual = moistureQ8ToPercent(countsToMoistureQ8(curve, counts));
+        if (actual != expected) {
+          snprintf(detail, detailCap, "curve %ld..%ld at %ld: %d%%, dashboard %d%%",
+            static_cast<long>(wet), static_cast<long>(dry), static_cast<long>(counts), actual, expected);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,23 @@
+#include "bench.h"
+#include "status_report.h"
+
+static const StatusSnapshot sampleStatus = {
+  true, "192.168.1.73", -61, 86400, "board3", "1.0.0", "192.168.1.10", 3000,
+  38512, "Software/System restart", 312, 86000,
+};
+
+BENCHMARK(format_status_json, 20000) {
+  char body[512];
+  for (uint32_t i = 0; i < iterations; i++) {
+    size_t n = formatStatusJson(body, sizeof(body), sampleStatus);
+    benchKeep(n);
+  }
+}
+
+BENCHMARK(format_status_text, 20000) {
+  char body[512];
+  for (uint32_t i = 0; i < iterations; i++) {
+    size_t n = formatStatusText(body, sizeof(body), sampleStatus);
+    benchKeep(n);
+  }
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Compare a benchmark run against a stored baseline.
+
+Usage:
+  pio run -e native_bench -t exec | python3 bench/compare.py bench/baseline/native.csv
+  pio run -e native_bench -t exec | python3 bench/compare.py bench/baseline/native.csv --update
+
+Exits non-zero if any op got slower than the tolerance, allocates more than before, or a
+BENCH_CHECK failed. The harness reports the fastest of several rounds per case; several
+runs can be piped in together and the median run of each case is compared (and stored
+with --update). Pipe in a few runs for both the baseline and the check:
+
+  for i in 1 2 3 4 5; do .pio/build/native_bench/program; done | python3 bench/compare.py ...
+A case without a baseline row is reported but does not fail; add it with --update.
+"""
+
+import argparse
+import csv
+import io
+import sys
+
+FIELDS = ["name", "iterations", "ns_per_op", "cycles_per_op", "allocs_per_op", "bytes_per_op", "heap_delta"]
+
+
+def read_results(text):
+    # pio output is mixed with build logs; keep only CSV rows from the harness
+    lines = [l for l in text.splitlines() if l.count(",") == len(FIELDS) - 1 and not l.startswith("#")]
+    runs = {}
+    for row in csv.DictReader(io.StringIO("\n".join(lines)), fieldnames=FIELDS):
+        if row["name"] == "name":
+            continue
+        runs.setdefault(row["name"], []).append(row)
+    # Several runs piped in together: keep the median run of each case, so one
+    # unusually fast or slow run (host load, clock scaling) doesn't decide the result
+    rows = {}
+    for name, group in runs.items():
+        group.sort(key=lambda r: float(r["ns_per_op"]))
+        rows[name] = group[(len(group) - 1) // 2]
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("baseline")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed ns_per_op growth (0.25 = 25%%)")
+    parser.add_argument("--update", action="store_true", help="merge this run into the baseline file")
+    args = parser.parse_args()
+
+    text = sys.stdin.read()
+    current = read_results(text)
+    check_failures = [l.strip() for l in text.splitlines() if "# CHECK FAILED" in l]
+    for line in check_failures:
+        print(line.lstrip("# "))
+    if not current:
+        print("no benchmark results on stdin", file=sys.stderr)
+        return 2
+
+    try:
+        with open(args.baseline) as f:
+            baseline = read_results(f.read())
+    except FileNotFoundError:
+        baseline = {}
+
+    failed = bool(check_failures)
+    for name, row in current.items():
+        base = baseline.get(name)
+        if base is None:
+            print("%-28s %10s ns/op  (new, no baseline; add it with --update)" % (name, row["ns_per_op"]))
+            continue
+
+        ns, base_ns = float(row["ns_per_op"]), float(base["ns_per_op"])
+        allocs, base_allocs = float(row["allocs_per_op"]), float(base["allocs_per_op"])
+        bytes_, base_bytes = float(row["bytes_per_op"]), float(base["bytes_per_op"])
+
+        problems = []
+        if base_ns > 0 and ns > base_ns * (1 + args.tolerance):
+            problems.append("slower (%.1f -> %.1f ns/op)" % (base_ns, ns))
+        if allocs > base_allocs or bytes_ > base_bytes:
+            problems.append("more heap (%.2f/%.1f -> %.2f/%.1f allocs/bytes per op)" % (base_allocs, base_bytes, allocs, bytes_))
+
+        status = "REGRESSION: " + "; ".join(problems) if problems else "ok"
+        failed = failed or bool(problems)
+        print("%-28s %10.1f ns/op  %s" % (name, ns, status))
+
+    for name in baseline:
+        if name not in current:
+            print("%-28s %10s        (not in this run)" % (name, ""))
+
+    if args.update:
+        baseline.update(current)
+        with open(args.baseline, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=FIELDS, lineterminator="\n")
+            writer.writeheader()
+            for row in baseline.values():
+                writer.writerow(row)
+        print("baseline updated: " + args.baseline)
+        return 0
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
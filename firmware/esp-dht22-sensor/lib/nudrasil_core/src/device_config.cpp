@@ -0,0 +1,99 @@
+#include "device_config.h"
+
+#include <string.h>
+#include <ArduinoJson.h>
+
+ConfigParseResult parseDeviceConfig(const char* body, size_t length, DeviceConfig& out) {
+  JsonDocument doc;
+  DeserializationError err = deserializeJson(doc, body, length);
+  if (err) {
+    return ConfigParseResult::InvalidJson;
+  }
+
+  if (!doc["success"].as<bool>()) {
+    return ConfigParseResult::NotSuccessful;
+  }
+
+  JsonArray dataArray = doc["value"]["data"];
+  if (dataArray.size() == 0) {
+    return ConfigParseResult::NoDeviceConfig;
+  }
+
+  JsonObject deviceConfig = dataArray[0]["config"];
+  const char* defaultEnv = deviceConfig["defaultEnv"] | "prod";
+  JsonObject env = deviceConfig["environments"][defaultEnv];
+
+  const char* ip = env["ip"] | "";
+  int port = env["port"] | 0;
+
+  if (ip[0] == '\0' || strlen(ip) >= sizeof(out.serverIp) || port <= 0) {
+    return ConfigParseResult::InvalidServer;
+  }
+
+  strcpy(out.serverIp, ip);
+  out.serverPort = port;
+  out.sendSlotMs = deviceConfig["sendSlotMs"] | -1;
+
+  JsonObject intervals = deviceConfig["intervals"];
+  out.intervals.sendMs = intervals["sendIntervalMs"] | 0u;
+  out.intervals.probeMs = intervals["probeIntervalMs"] | 0u;
+  out.intervals.connectivityCheckMs = intervals["connectivityCheckIntervalMs"] | 0u;
+  out.intervals.configRefreshMs = intervals["configRefreshIntervalMs"] | 0u;
+  out.intervals.maxNoPostMs = intervals["maxNoPostBeforeRestartMs"] | 0u;
+  out.intervals.maxWiFiDownMs = intervals["maxWiFiDownBeforeRestartMs"] | 0u;
+  out.intervals.maxConfigFailMs = intervals["maxConfigFetchFailBeforeRestartMs"] | 0u;
+  out.calibrationCount = 0;
+
+  // [{ sensor, min, max, points?: [[counts, percent], ...] }]
+  JsonArray calibration = doc["value"]["calibration"];
+  for (JsonObject entry : calibration) {
+    if (out.calibrationCount >= DeviceConfig::kMaxCalibrations) {
+      break;
+    }
+
+    const char* sensor = entry["sensor"] | "";
+    if (sensor[0] == '\0' || strlen(sensor) >= sizeof(out.calibrations[0].sensor)) {
+      continue;
+    }
+
+    SensorCalibration& cal = out.calibrations[out.calibrationCount];
+    bool built = false;
+
+    JsonArray points = entry["points"];
+    if (points.size() >= 2 && points.size() <= CalibrationCurve::kMaxPoints) {
+      float counts[CalibrationCurve::kMaxPoints];
+      float percents[CalibrationCurve::kMaxPoints];
+      uint8_t n = 0;
+      bool numeric = true;
+      for (JsonArray point : points) {
+        // A missing or non-numeric value rejects the curve rather than reading as 0
+        numeric = numeric && point[0].is<float>() && point[1].is<float>();
+        counts[n] = point[0] | 0.0f;
+        percents[n] = point[1] | 0.0f;
+        n++;
+      }
+      // Also rejects points out of range or not in increasing counts order
+      built = numeric && buildCalibrationCurve(cal.curve, counts, percents, n);
+    } else if (entry["min"].is<float>() && entry["max"].is<float>()) {
+      built = buildTwoPointCurve(cal.curve, entry["min"].as<float>(), entry["max"].as<float>());
+    }
+
+    if (built) {
+      strcpy(cal.sensor, sensor);
+      out.calibrationCount++;
+    }
+  }
+
+  return ConfigParseResult::Ok;
+}
+
+const char* configParseResultMessage(ConfigParseResult result) {
+  switch (result) {
+    case ConfigParseResult::Ok: return "ok";
+    case ConfigParseResult::InvalidJson: return "Failed to parse config";
+    case ConfigParseResult::NotSuccessful: return "Config fetch returned success: false";
+    case ConfigParseResult::NoDeviceConfig: return "No device config data found";
+    case ConfigParseResult::InvalidServer: return "Config parsed but serverIp or serverPort is invalid";
+  }
+  return "unknown";
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "device_intervals.h"
+#include "sensor_math.h"
+
+// Moisture calibration for one sensor, from the `calibration` list in the config response
+struct SensorCalibration {
+  char sensor[32];
+  CalibrationCurve curve;
+};
+
+// Parsed subset of the api/admin/device-configs response for this board.
+struct DeviceConfig {
+  static const uint8_t kMaxCalibrations = 4;
+
+  char serverIp[40];
+  int serverPort;
+
+  // Offset of this board's uploads within the send interval; -1 = derive from the device id
+  int32_t sendSlotMs;
+
+  // As sent by the server (0 = not set); run through boundDeviceIntervals() before use
+  DeviceIntervals intervals;
+
+  // Optional; sensors without a usable calibration are skipped
+  SensorCalibration calibrations[kMaxCalibrations];
+  uint8_t calibrationCount;
+};
+
+enum class ConfigParseResult {
+  Ok,
+  InvalidJson,
+  NotSuccessful,
+  NoDeviceConfig,
+  InvalidServer,
+};
+
+// Parses the config endpoint body. `out` is only written when the result is Ok.
+ConfigParseResult parseDeviceConfig(const char* body, size_t length, DeviceConfig& out);
+
+const char* configParseResultMessage(ConfigParseResult result);
@@ -0,0 +1,64 @@
+#include "device_intervals.h"
+
+namespace {
+
+const uint32_t kSecond = 1000UL;
+const uint32_t kMinute = 60UL * kSecond;
+const uint32_t kHour = 60UL * kMinute;
+
+struct Bound {
+  uint32_t DeviceIntervals::*field;
+  uint32_t minMs;
+  uint32_t maxMs;
+};
+
+const Bound kBounds[] = {
+  { &DeviceIntervals::sendMs, 30UL * kSecond, 6UL * kHour },
+  { &DeviceIntervals::probeMs, 10UL * kSecond, 1UL * kHour },
+  { &DeviceIntervals::connectivityCheckMs, 2UL * kSecond, 5UL * kMinute },
+  { &DeviceIntervals::configRefreshMs, 1UL * kMinute, 24UL * kHour },
+  { &DeviceIntervals::maxNoPostMs, 5UL * kMinute, 24UL * kHour },
+  { &DeviceIntervals::maxWiFiDownMs, 2UL * kMinute, 1UL * kHour },
+  { &DeviceIntervals::maxConfigFailMs, 1UL * kMinute, 30UL * kMinute },
+};
+
+}  // namespace
+
+DeviceIntervals defaultDeviceIntervals() {
+  DeviceIntervals d;
+  d.sendMs = 10UL * kMinute;
+  d.probeMs = 1UL * kMinute;
+  d.connectivityCheckMs = 10UL * kSecond;
+  d.configRefreshMs = 15UL * kMinute;
+  d.maxNoPostMs = 15UL * kMinute;
+  d.maxWiFiDownMs = 8UL * kMinute;
+  d.maxConfigFailMs = 2UL * kMinute;
+  return d;
+}
+
+uint8_t boundDeviceIntervals(DeviceIntervals& intervals, const DeviceIntervals& fallback) {
+  uint8_t clamped = 0;
+
+  for (const Bound& b : kBounds) {
+    uint32_t& value = intervals.*b.field;
+    if (value == 0) {
+      value = fallback.*b.field;
+    }
+    if (value < b.minMs) {
+      value = b.minMs;
+      clamped++;
+    } else if (value > b.maxMs) {
+      value = b.maxMs;
+      clamped++;
+    }
+  }
+
+  // A slow send interval must not trip the no-post restart between two cycles
+  uint32_t minNoPost = intervals.sendMs + intervals.sendMs / 2;
+  if (intervals.maxNoPostMs < minNoPost) {
+    intervals.maxNoPostMs = minNoPost;
+    clamped++;
+  }
+
+  return clamped;
+}
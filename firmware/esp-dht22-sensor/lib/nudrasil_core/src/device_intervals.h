@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// Timing knobs the device config can override (`config.intervals`), all in milliseconds.
+// 0 means "not set" and falls back to the firmware default.
+struct DeviceIntervals {
+  uint32_t sendMs;
+  uint32_t probeMs;
+  uint32_t connectivityCheckMs;
+  uint32_t configRefreshMs;
+  uint32_t maxNoPostMs;
+  uint32_t maxWiFiDownMs;
+  uint32_t maxConfigFailMs;
+};
+
+// The values the firmware ships with
+DeviceIntervals defaultDeviceIntervals();
+
+// Fills unset fields from `fallback` and clamps the rest into safe bounds, so a bad config can't
+// hammer the server or put the board in a restart loop (the no-post failsafe always covers at
+// least 1.5 send intervals). Returns the number of fields that had to be clamped.
+uint8_t boundDeviceIntervals(DeviceIntervals& intervals, const DeviceIntervals& fallback);
@@ -0,0 +1,57 @@
+#include "firmware_version.h"
+
+#include <string.h>
+
+bool parseFirmwareVersion(const char* text, FirmwareVersion& out) {
+  memset(out.parts, 0, sizeof(out.parts));
+
+  uint8_t part = 0;
+  bool digits = false;
+  for (const char* p = text; ; p++) {
+    if (*p >= '0' && *p <= '9') {
+      uint32_t digit = static_cast<uint32_t>(*p - '0');
+      if (out.parts[part] > (UINT32_MAX - digit) / 10) {
+        return false;  // overflow
+      }
+      out.parts[part] = out.parts[part] * 10 + digit;
+      digits = true;
+    } else if (*p == '.' || *p == '\0') {
+      if (!digits) {
+        return false;  // empty part: "", ".1", "1..2", "1."
+      }
+      if (*p == '\0') {
+        return true;
+      }
+      if (++part >= FirmwareVersion::kMaxParts) {
+        return false;
+      }
+      digits = false;
+    } else {
+      return false;
+    }
+  }
+}
+
+int compareFirmwareVersions(const FirmwareVersion& a, const FirmwareVersion& b) {
+  for (uint8_t i = 0; i < FirmwareVersion::kMaxParts; i++) {
+    if (a.parts[i] != b.parts[i]) {
+      return a.parts[i] < b.parts[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+bool shouldInstallFirmware(const char* current, const char* offered, bool allowDowngrade) {
+  FirmwareVersion offeredVersion;
+  if (!parseFirmwareVersion(offered, offeredVersion)) {
+    return false;
+  }
+
+  FirmwareVersion currentVersion;
+  if (!parseFirmwareVersion(current, currentVersion)) {
+    return true;
+  }
+
+  int order = compareFirmwareVersions(offeredVersion, currentVersion);
+  return order > 0 || (order < 0 && allowDowngrade);
+}
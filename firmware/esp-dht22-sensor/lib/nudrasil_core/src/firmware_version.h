@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+// Dotted numeric firmware versions ("1.2.10"), up to four parts; missing parts count as 0.
+struct FirmwareVersion {
+  static const uint8_t kMaxParts = 4;
+  uint32_t parts[kMaxParts];
+};
+
+// False for anything that isn't digits and dots (e.g. "dev" or "1.2-rc1")
+bool parseFirmwareVersion(const char* text, FirmwareVersion& out);
+
+// <0, 0, >0 like strcmp
+int compareFirmwareVersions(const FirmwareVersion& a, const FirmwareVersion& b);
+
+// Whether a board running `current` should install the manifest's `offered` version. Only
+// newer versions are taken unless the manifest sets allowDowngrade, so a stale or rolled-back
+// manifest can't downgrade the fleet. Unversioned local builds ("dev") take any release.
+bool shouldInstallFirmware(const char* current, const char* offered, bool allowDowngrade);
@@ -0,0 +1,107 @@
+#include "http_endpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool parseHttpUrl(const char* url, HttpUrl& out) {
+  static const char scheme[] = "http://";
+  if (strncmp(url, scheme, sizeof(scheme) - 1) != 0) {
+    return false;
+  }
+
+  const char* host = url + sizeof(scheme) - 1;
+  const char* hostEnd = host;
+  while (*hostEnd && *hostEnd != ':' && *hostEnd != '/') {
+    hostEnd++;
+  }
+
+  size_t hostLen = hostEnd - host;
+  if (hostLen == 0 || hostLen >= sizeof(out.host)) {
+    return false;
+  }
+
+  uint16_t port = 80;
+  const char* path = hostEnd;
+  if (*hostEnd == ':') {
+    char* portEnd = nullptr;
+    long parsed = strtol(hostEnd + 1, &portEnd, 10);
+    if (portEnd == hostEnd + 1 || parsed <= 0 || parsed > 65535) {
+      return false;
+    }
+    port = static_cast<uint16_t>(parsed);
+    path = portEnd;
+  }
+
+  // Normalize to "/.../" so callers can append "api/sensor"
+  size_t pathLen = strlen(path);
+  bool needsLead = pathLen == 0 || path[0] != '/';
+  bool needsTrail = pathLen == 0 || path[pathLen - 1] != '/';
+  size_t total = pathLen + (needsLead ? 1 : 0) + (needsTrail && pathLen > 0 ? 1 : 0);
+  if (total >= sizeof(out.basePath)) {
+    return false;
+  }
+
+  memcpy(out.host, host, hostLen);
+  out.host[hostLen] = '\0';
+  out.port = port;
+
+  snprintf(out.basePath, sizeof(out.basePath), "%s%s%s",
+    needsLead ? "/" : "", path, (needsTrail && pathLen > 0) ? "/" : "");
+  return true;
+}
+
+size_t buildRequestHead(char* out, size_t cap, const char* method, const HttpUrl& url, const char* path,
+                        const char* authorization, const char* contentType, size_t contentLength) {
+  char hostHeader[72];
+  if (url.port == 80) {
+    snprintf(hostHeader, sizeof(hostHeader), "%s", url.host);
+  } else {
+    snprintf(hostHeader, sizeof(hostHeader), "%s:%u", url.host, static_cast<unsigned>(url.port));
+  }
+
+  int n = snprintf(out, cap,
+    "%s %s%s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\nUser-Agent: ESP8266\r\n",
+    method, url.basePath, path, hostHeader);
+  if (n < 0 || static_cast<size_t>(n) >= cap) {
+    return 0;
+  }
+  size_t len = n;
+
+  if (authorization) {
+    n = snprintf(out + len, cap - len, "Authorization: %s\r\n", authorization);
+    if (n < 0 || len + n >= cap) {
+      return 0;
+    }
+    len += n;
+  }
+
+  if (contentType) {
+    n = snprintf(out + len, cap - len, "Content-Type: %s\r\nContent-Length: %lu\r\n",
+      contentType, static_cast<unsigned long>(contentLength));
+    if (n < 0 || len + n >= cap) {
+      return 0;
+    }
+    len += n;
+  }
+
+  if (len + 2 >= cap) {
+    return 0;
+  }
+  out[len++] = '\r';
+  out[len++] = '\n';
+  out[len] = '\0';
+  return len;
+}
+
+int parseStatusLine(const char* line) {
+  if (strncmp(line, "HTTP/1.", 7) != 0) {
+    return -1;
+  }
+  const char* space = strchr(line, ' ');
+  if (!space) {
+    return -1;
+  }
+  int code = atoi(space + 1);
+  return (code >= 100 && code <= 599) ? code : -1;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pieces of SERVER_URL needed to talk to the server without HTTPClient, so uploads can
+// connect to a known IP while still sending the right Host header.
+struct HttpUrl {
+  char host[64];
+  uint16_t port;
+  char basePath[64];  // always starts and ends with '/'
+};
+
+// Accepts http://host[:port][/path]. Returns false for anything else (including https).
+bool parseHttpUrl(const char* url, HttpUrl& out);
+
+// Request line and headers up to and including the blank line. HTTP/1.0, so responses are
+// never chunked and the body is simply everything up to the close. `path` is relative to
+// basePath; `contentType` may be null for bodyless requests. Returns 0 if it didn't fit.
+size_t buildRequestHead(char* out, size_t cap, const char* method, const HttpUrl& url, const char* path,
+                        const char* authorization, const char* contentType, size_t contentLength);
+
+// "HTTP/1.1 200 OK" -> 200; -1 if the line isn't an HTTP status line
+int parseStatusLine(const char* line);
@@ -0,0 +1,144 @@
+#include "lzss.h"
+
+namespace {
+
+const size_t kWindow = 1u << kLzssWindowBits;
+const size_t kMaxMatch = 1u << kLzssLookaheadBits;
+// A back-reference costs 13 bits, two literals 18
+const size_t kMinMatch = 2;
+
+class BitWriter {
+ public:
+  BitWriter(uint8_t* out, size_t cap) : out_(out), cap_(cap), len_(0), mask_(0x80), overflow_(false) {}
+
+  void put(uint32_t value, uint8_t bits) {
+    while (bits > 0) {
+      bits--;
+      if (mask_ == 0x80) {
+        if (len_ >= cap_) {
+          overflow_ = true;
+          return;
+        }
+        out_[len_++] = 0;
+      }
+      if (value & (1UL << bits)) {
+        out_[len_ - 1] |= mask_;
+      }
+      mask_ >>= 1;
+      if (mask_ == 0) {
+        mask_ = 0x80;
+      }
+    }
+  }
+
+  size_t length() const { return overflow_ ? 0 : len_; }
+
+ private:
+  uint8_t* out_;
+  size_t cap_;
+  size_t len_;
+  uint8_t mask_;
+  bool overflow_;
+};
+
+class BitReader {
+ public:
+  BitReader(const uint8_t* in, size_t len) : in_(in), bitsLeft_(len * 8), pos_(0) {}
+
+  bool get(uint8_t bits, uint32_t& value) {
+    if (bits > bitsLeft_) {
+      return false;
+    }
+    value = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+      uint8_t bit = (in_[pos_ >> 3] >> (7 - (pos_ & 7))) & 1;
+      value = (value << 1) | bit;
+      pos_++;
+    }
+    bitsLeft_ -= bits;
+    return true;
+  }
+
+ private:
+  const uint8_t* in_;
+  size_t bitsLeft_;
+  size_t pos_;
+};
+
+}  // namespace
+
+size_t lzssCompress(const uint8_t* in, size_t len, uint8_t* out, size_t cap) {
+  BitWriter writer(out, cap);
+  size_t i = 0;
+
+  while (i < len) {
+    size_t bestLen = 0;
+    size_t bestDist = 0;
+    size_t maxLen = len - i < kMaxMatch ? len - i : kMaxMatch;
+    size_t start = i > kWindow ? i - kWindow : 0;
+
+    // Nearest match first; a longer one further back only wins if strictly longer
+    for (size_t j = i; j-- > start;) {
+      size_t n = 0;
+      while (n < maxLen && in[j + n] == in[i + n]) {
+        n++;
+      }
+      if (n > bestLen) {
+        bestLen = n;
+        bestDist = i - j;
+        if (n == maxLen) {
+          break;
+        }
+      }
+    }
+
+    if (bestLen >= kMinMatch) {
+      writer.put(0, 1);
+      writer.put(bestDist - 1, kLzssWindowBits);
+      writer.put(bestLen - 1, kLzssLookaheadBits);
+      i += bestLen;
+    } else {
+      writer.put(1, 1);
+      writer.put(in[i], 8);
+      i++;
+    }
+  }
+
+  return writer.length();
+}
+
+size_t lzssDecompress(const uint8_t* in, size_t len, uint8_t* out, size_t cap) {
+  BitReader reader(in, len);
+  size_t n = 0;
+  uint32_t tag;
+
+  // Trailing pad bits never form a whole record, so running out of bits is the normal end
+  while (reader.get(1, tag)) {
+    uint32_t value;
+    if (tag) {
+      if (!reader.get(8, value)) {
+        break;
+      }
+      if (n >= cap) {
+        return 0;
+      }
+      out[n++] = static_cast<uint8_t>(value);
+      continue;
+    }
+
+    uint32_t count;
+    if (!reader.get(kLzssWindowBits, value) || !reader.get(kLzssLookaheadBits, count)) {
+      break;
+    }
+    size_t dist = value + 1;
+    count += 1;
+    if (dist > n || n + count > cap) {
+      return 0;
+    }
+    for (uint32_t k = 0; k < count; k++, n++) {
+      out[n] = out[n - dist];
+    }
+  }
+
+  return n;
+}
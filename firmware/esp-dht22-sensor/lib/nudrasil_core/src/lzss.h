@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// LZSS in heatshrink's bitstream format (window_sz2 = 8, lookahead_sz2 = 4), so the output
+// can be checked with the reference `heatshrink -d -w 8 -l 4`. Bits are packed MSB first:
+//   1 + 8 bits                    literal byte
+//   0 + 8 bits + 4 bits           back-reference: (distance - 1), (length - 1)
+// Compresses a whole buffer in one call; no state beyond the stack.
+static const uint8_t kLzssWindowBits = 8;
+static const uint8_t kLzssLookaheadBits = 4;
+
+// Returns the compressed length, or 0 if it would not fit in `cap`.
+size_t lzssCompress(const uint8_t* in, size_t len, uint8_t* out, size_t cap);
+
+// Inverse of lzssCompress(); returns the decompressed length, or 0 on overflow/corrupt input.
+size_t lzssDecompress(const uint8_t* in, size_t len, uint8_t* out, size_t cap);
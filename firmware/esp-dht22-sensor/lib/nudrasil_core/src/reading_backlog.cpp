@@ -0,0 +1,269 @@
+#include "reading_backlog.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "lzss.h"
+
+namespace {
+
+class ByteWriter {
+ public:
+  ByteWriter(uint8_t* out, size_t cap) : out_(out), cap_(cap), len_(0), overflow_(false) {}
+
+  void byte(uint8_t b) {
+    if (len_ >= cap_) {
+      overflow_ = true;
+      return;
+    }
+    out_[len_++] = b;
+  }
+
+  void varint(uint32_t v) {
+    while (v >= 0x80) {
+      byte(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    byte(static_cast<uint8_t>(v));
+  }
+
+  void zigzag(int32_t v) {
+    varint((static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31));
+  }
+
+  void bytes(const void* data, size_t n) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < n; i++) {
+      byte(p[i]);
+    }
+  }
+
+  size_t length() const { return overflow_ ? 0 : len_; }
+
+ private:
+  uint8_t* out_;
+  size_t cap_;
+  size_t len_;
+  bool overflow_;
+};
+
+void putLe(uint8_t* out, uint32_t v, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    out[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+int32_t toHundredths(float v) {
+  return static_cast<int32_t>(lroundf(v * 100.0f));
+}
+
+}  // namespace
+
+ReadingBacklog::ReadingBacklog()
+  : names_(), sensorCount_(0), tail_(0), count_(0), overwritten_(0), bootId_(0), deviceId_("") {}
+
+int8_t ReadingBacklog::sensorIndex(const char* name) {
+  for (uint8_t i = 0; i < sensorCount_; i++) {
+    if (strcmp(names_[i], name) == 0) {
+      return i;
+    }
+  }
+  if (sensorCount_ >= kMaxSensors || strlen(name) > kMaxNameLength) {
+    return -1;
+  }
+  strcpy(names_[sensorCount_], name);
+  return sensorCount_++;
+}
+
+void ReadingBacklog::push(const char* name, uint32_t seq, uint32_t timestampMs, float value, float calibrated) {
+  int8_t sensor = sensorIndex(name);
+  if (sensor < 0) {
+    return;
+  }
+
+  if (count_ == kCapacity) {
+    tail_ = (tail_ + 1) % kCapacity;
+    count_--;
+    overwritten_++;
+  }
+
+  Entry& e = entries_[(tail_ + count_) % kCapacity];
+  e.seq = seq;
+  e.timestampMs = timestampMs;
+  e.value = value;
+  e.calibratedQ = (isnan(calibrated) || calibrated < 0.0f || calibrated > 600.0f)
+    ? kNoCalibration
+    : static_cast<uint16_t>(lroundf(calibrated * 100.0f));
+  e.sensor = static_cast<uint8_t>(sensor);
+  count_++;
+}
+
+void ReadingBacklog::ackThrough(uint32_t nextSeq) {
+  // Signed distance so a stale ack can't drop unsent readings
+  while (count_ > 0 && static_cast<int32_t>(nextSeq - at(0).seq) > 0) {
+    tail_ = (tail_ + 1) % kCapacity;
+    count_--;
+  }
+}
+
+size_t ReadingBacklog::encodeBody(uint8_t* out, size_t cap, uint32_t nowMs, uint16_t count) const {
+  ByteWriter w(out, cap);
+
+  size_t deviceLen = strlen(deviceId_);
+  w.varint(deviceLen);
+  w.bytes(deviceId_, deviceLen);
+
+  bool present[kMaxSensors] = { false };
+  uint8_t blocks = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint8_t s = at(i).sensor;
+    if (!present[s]) {
+      present[s] = true;
+      blocks++;
+    }
+  }
+  w.varint(blocks);
+
+  for (uint8_t s = 0; s < sensorCount_; s++) {
+    if (!present[s]) {
+      continue;
+    }
+
+    uint16_t n = 0;
+    uint16_t calibrated = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      const Entry& e = at(i);
+      if (e.sensor == s) {
+        n++;
+        calibrated += (e.calibratedQ != kNoCalibration) ? 1 : 0;
+      }
+    }
+
+    size_t nameLen = strlen(names_[s]);
+    w.varint(nameLen);
+    w.bytes(names_[s], nameLen);
+    w.varint(n);
+    // A sensor can gain or lose its calibration mid-outage; mark which readings have one
+    bool partial = calibrated > 0 && calibrated < n;
+    w.byte((calibrated > 0 ? 0x01 : 0) | (partial ? 0x02 : 0));
+
+    // Timestamps: age of the oldest, then delta-of-delta (0 for a steady send interval).
+    // Ages come from millisecond differences, which stay right across a millis() wrap and
+    // for restored readings; seconds cut from the raw timestamps would not.
+    bool first = true;
+    uint32_t prevAgeSec = 0;
+    int32_t prevDelta = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      const Entry& e = at(i);
+      if (e.sensor != s) {
+        continue;
+      }
+      uint32_t ageSec = (nowMs - e.timestampMs) / 1000;
+      if (first) {
+        w.varint(ageSec);
+        first = false;
+      } else {
+        int32_t delta = static_cast<int32_t>(prevAgeSec - ageSec);
+        w.zigzag(delta - prevDelta);
+        prevDelta = delta;
+      }
+      prevAgeSec = ageSec;
+    }
+
+    // Sequences step by the number of sensors per cycle, so the deltas compress well
+    uint32_t prevSeq = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      const Entry& e = at(i);
+      if (e.sensor == s) {
+        w.zigzag(static_cast<int32_t>(e.seq - prevSeq));
+        prevSeq = e.seq;
+      }
+    }
+
+    int32_t prevValue = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      const Entry& e = at(i);
+      if (e.sensor == s) {
+        int32_t v = toHundredths(e.value);
+        w.zigzag(v - prevValue);
+        prevValue = v;
+      }
+    }
+
+    if (partial) {
+      uint8_t bits = 0;
+      uint16_t k = 0;
+      for (uint16_t i = 0; i < count; i++) {
+        const Entry& e = at(i);
+        if (e.sensor != s) {
+          continue;
+        }
+        if (e.calibratedQ != kNoCalibration) {
+          bits |= static_cast<uint8_t>(1 << (k % 8));
+        }
+        if (++k % 8 == 0) {
+          w.byte(bits);
+          bits = 0;
+        }
+      }
+      if (k % 8 != 0) {
+        w.byte(bits);
+      }
+    }
+
+    if (calibrated > 0) {
+      int32_t prevCal = 0;
+      for (uint16_t i = 0; i < count; i++) {
+        const Entry& e = at(i);
+        if (e.sensor == s && e.calibratedQ != kNoCalibration) {
+          w.zigzag(static_cast<int32_t>(e.calibratedQ) - prevCal);
+          prevCal = e.calibratedQ;
+        }
+      }
+    }
+  }
+
+  return w.length();
+}
+
+size_t ReadingBacklog::encodeChunk(uint8_t* out, size_t cap, uint8_t* scratch, size_t scratchCap,
+                                   uint32_t nowMs, uint16_t maxReadings, uint16_t& covered) const {
+  covered = 0;
+  if (count_ == 0 || cap <= kHeaderSize) {
+    return 0;
+  }
+
+  // Halve until the body fits both buffers; a reading is ~2-3 bytes raw, so this rarely loops
+  uint16_t n = count_ < maxReadings ? count_ : maxReadings;
+  while (n > 0) {
+    size_t raw = encodeBody(scratch, scratchCap, nowMs, n);
+    if (raw > 0 && raw <= 0xFFFF) {
+      uint8_t flags = 0;
+      size_t bodyLen = lzssCompress(scratch, raw, out + kHeaderSize, cap - kHeaderSize);
+      if (bodyLen == 0 || bodyLen >= raw) {
+        bodyLen = raw;
+        if (kHeaderSize + raw > cap) {
+          n /= 2;
+          continue;
+        }
+        memcpy(out + kHeaderSize, scratch, raw);
+      } else {
+        flags |= 0x01;
+      }
+
+      out[0] = 'N';
+      out[1] = 'B';
+      out[2] = kVersion;
+      out[3] = flags;
+      putLe(out + 4, bootId_, 4);
+      putLe(out + 8, firstSeq(), 4);
+      putLe(out + 12, n, 2);
+      putLe(out + 14, static_cast<uint32_t>(raw), 2);
+      covered = n;
+      return kHeaderSize + bodyLen;
+    }
+    n /= 2;
+  }
+
+  return 0;
+}
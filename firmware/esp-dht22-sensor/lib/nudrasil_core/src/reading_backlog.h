@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Readings that could not be posted one by one, replayed in bulk to api/sensor/bulk.
+//
+// Each reading keeps the per-device sequence number it was read with (ascending in push
+// order). Chunks always cover the oldest entries, and the server acknowledges a chunk by
+// returning the next sequence it expects, so an interrupted replay resumes from the first
+// unacknowledged reading and a chunk sent twice is deduplicated by (device, seq).
+//
+// Chunk layout (integers little-endian):
+//   "NB" version flags   flags bit 0: body is LZSS/heatshrink compressed (see lzss.h)
+//   u32 boot id, u32 first seq, u16 reading count, u16 raw body length
+//   body:
+//     varint device id length, device id
+//     varint sensor block count
+//     per block: varint name length, name, varint reading count,
+//                u8 flags (bit 0: calibrated values follow, bit 1: only for some readings),
+//                varint age of the oldest reading in seconds,
+//                (count - 1) x zigzag varint: delta-of-delta of the timestamps in seconds
+//                  (age[i - 1] - age[i], so they decode as ages),
+//                count x zigzag varint: delta of seq,
+//                count x zigzag varint: delta of value * 100,
+//                [bit 1: ceil(count / 8) bytes, bit i (LSB first) set if reading i is calibrated]
+//                [bit 0: zigzag varint delta of calibrated * 100 per calibrated reading]
+// Version 2 chunks are the same without flag bit 1.
+//
+// save()/restore() keep the backlog across restarts in a file (see src/main.cpp). Timestamps
+// are stored as ages, so time spent powered off is not counted in the restored ages.
+class ReadingBacklog {
+ public:
+  static const uint8_t kMaxSensors = 8;
+  static const uint8_t kMaxNameLength = 31;
+  static const uint16_t kCapacity = 512;  // 16 bytes each
+  static const size_t kHeaderSize = 16;
+  static const uint8_t kVersion = 3;
+
+  ReadingBacklog();
+
+  void setBootId(uint32_t bootId) { bootId_ = bootId; }
+  // Must outlive the backlog (DEVICE_ID is a compile-time constant)
+  void setDeviceId(const char* deviceId) { deviceId_ = deviceId; }
+
+  // When full, the oldest reading is overwritten. `seq` must be higher than any seq already
+  // pushed; `calibrated` may be NaN. Readings of a ninth sensor or with a name longer than
+  // kMaxNameLength are dropped.
+  void push(const char* name, uint32_t seq, uint32_t timestampMs, float value, float calibrated);
+
+  uint16_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  uint32_t firstSeq() const { return count_ ? at(0).seq : 0; }
+  uint32_t overwritten() const { return overwritten_; }
+
+  // Drops every reading with seq < nextSeq (the server's acknowledgement).
+  void ackThrough(uint32_t nextSeq);
+
+  // The acknowledgement that covers the oldest `covered` readings (1..size())
+  uint32_t nextSeqAfter(uint16_t covered) const { return at(covered - 1).seq + 1; }
+
+  // Encodes up to `maxReadings` of the oldest readings as one chunk. `scratch` holds the
+  // uncompressed body. Returns the chunk length (0 if empty or nothing fits) and the number
+  // of readings it covers in `covered`.
+  size_t encodeChunk(uint8_t* out, size_t cap, uint8_t* scratch, size_t scratchCap,
+                     uint32_t nowMs, uint16_t maxReadings, uint16_t& covered) const;
+
+  // `out` needs write(const uint8_t*, size_t) and `in` read(uint8_t*, size_t), like a
+  // LittleFS File. Call restore() before the first push(); it leaves the backlog empty if the
+  // data is missing or invalid.
+  template <typename Writer> bool save(Writer& out, uint32_t nowMs) const;
+  template <typename Reader> bool restore(Reader& in, uint32_t nowMs);
+
+ private:
+  struct Entry {
+    uint32_t seq;
+    uint32_t timestampMs;
+    float value;
+    uint16_t calibratedQ;  // calibrated * 100, kNoCalibration when absent
+    uint8_t sensor;
+  };
+
+  static const uint16_t kNoCalibration = 0xFFFF;
+  static const uint32_t kSaveMagic = 0x4E424C31;  // "NBL1"; change when Entry changes
+
+  struct SaveHeader {
+    uint32_t magic;
+    uint16_t count;
+    uint8_t sensorCount;
+    uint8_t reserved;
+    uint32_t overwritten;
+    char names[kMaxSensors][kMaxNameLength + 1];
+  };
+
+  int8_t sensorIndex(const char* name);
+  const Entry& at(uint16_t i) const { return entries_[(tail_ + i) % kCapacity]; }
+  size_t encodeBody(uint8_t* out, size_t cap, uint32_t nowMs, uint16_t count) const;
+
+  Entry entries_[kCapacity];
+  char names_[kMaxSensors][kMaxNameLength + 1];
+  uint8_t sensorCount_;
+  uint16_t tail_;   // oldest entry
+  uint16_t count_;
+  uint32_t overwritten_;
+  uint32_t bootId_;
+  const char* deviceId_;
+};
+
+template <typename Writer>
+bool ReadingBacklog::save(Writer& out, uint32_t nowMs) const {
+  SaveHeader header = {};
+  header.magic = kSaveMagic;
+  header.count = count_;
+  header.sensorCount = sensorCount_;
+  header.overwritten = overwritten_;
+  memcpy(header.names, names_, sizeof(header.names));
+  if (out.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+
+  for (uint16_t i = 0; i < count_; i++) {
+    Entry e = at(i);
+    e.timestampMs = nowMs - e.timestampMs;  // age
+    if (out.write(reinterpret_cast<const uint8_t*>(&e), sizeof(e)) != sizeof(e)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Reader>
+bool ReadingBacklog::restore(Reader& in, uint32_t nowMs) {
+  tail_ = 0;
+  count_ = 0;
+
+  SaveHeader header;
+  if (in.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+      header.magic != kSaveMagic || header.count > kCapacity || header.sensorCount > kMaxSensors) {
+    return false;
+  }
+
+  // Replaces the sensor table, so this runs before the first push()
+  memcpy(names_, header.names, sizeof(names_));
+  for (uint8_t i = 0; i < kMaxSensors; i++) {
+    names_[i][kMaxNameLength] = '\0';
+  }
+  sensorCount_ = header.sensorCount;
+  overwritten_ = header.overwritten;
+
+  for (uint16_t i = 0; i < header.count; i++) {
+    Entry& e = entries_[i];
+    if (in.read(reinterpret_cast<uint8_t*>(&e), sizeof(e)) != sizeof(e) || e.sensor >= sensorCount_ ||
+        (i > 0 && static_cast<int32_t>(e.seq - entries_[i - 1].seq) <= 0)) {
+      count_ = 0;
+      return false;
+    }
+    e.timestampMs = nowMs - e.timestampMs;
+    count_++;
+  }
+  return true;
+}
@@ -0,0 +1,108 @@
+#include "reading_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+ReadingCache::ReadingCache() : sensorCount_(0), latestSeq_(0), bootId_(0) {}
+
+int8_t ReadingCache::slotFor(const char* name) {
+  for (uint8_t i = 0; i < sensorCount_; i++) {
+    if (sensors_[i].name == name || strcmp(sensors_[i].name, name) == 0) {
+      return i;
+    }
+  }
+
+  if (sensorCount_ >= kMaxSensors) {
+    return -1;
+  }
+
+  SensorRing& ring = sensors_[sensorCount_];
+  ring.name = name;
+  ring.head = 0;
+  ring.count = 0;
+  return sensorCount_++;
+}
+
+void ReadingCache::record(const char* name, uint32_t timestampMs, float value) {
+  int8_t slot = slotFor(name);
+  if (slot < 0) {
+    return;
+  }
+
+  SensorRing& ring = sensors_[slot];
+  ring.entries[ring.head] = { ++latestSeq_, timestampMs, value };
+  ring.head = (ring.head + 1) % kDepth;
+  if (ring.count < kDepth) {
+    ring.count++;
+  }
+}
+
+size_t ReadingCache::formatReadings(char* out, size_t cap, uint32_t sinceSeq, uint32_t nowMs, ReadingCacheCursor& cursor) const {
+  size_t len = 0;
+
+  // Appends one line if it fits whole; otherwise leaves `out` untouched for the next page
+  auto append = [&](const char* line, size_t n) {
+    if (len + n >= cap) {
+      return false;
+    }
+    memcpy(out + len, line, n);
+    len += n;
+    out[len] = '\0';
+    return true;
+  };
+
+  char line[64];
+
+  if (cursor.stage == 0) {
+    int n = snprintf(line, sizeof(line), "latest,%lu,%08lx\n",
+      static_cast<unsigned long>(latestSeq_), static_cast<unsigned long>(bootId_));
+    if (!append(line, n)) {
+      return 0;
+    }
+    if (!append("sensors", 7)) {
+      return 0;
+    }
+    for (uint8_t i = 0; i < sensorCount_; i++) {
+      n = snprintf(line, sizeof(line), ",%s", sensors_[i].name);
+      if (!append(line, n)) {
+        return 0;
+      }
+    }
+    if (!append("\n", 1)) {
+      return 0;
+    }
+    cursor.stage = 1;
+  }
+
+  while (cursor.stage == 1) {
+    if (cursor.sensor >= sensorCount_) {
+      cursor.stage = 2;
+      break;
+    }
+
+    const SensorRing& ring = sensors_[cursor.sensor];
+    if (cursor.offset >= ring.count) {
+      cursor.sensor++;
+      cursor.offset = 0;
+      continue;
+    }
+
+    // Oldest first within each sensor
+    uint8_t pos = (ring.head + kDepth - ring.count + cursor.offset) % kDepth;
+    const Entry& e = ring.entries[pos];
+
+    if (e.seq > sinceSeq) {
+      int n = snprintf(line, sizeof(line), "%lu,%u,%lu,%.2f\n",
+        static_cast<unsigned long>(e.seq),
+        static_cast<unsigned>(cursor.sensor),
+        static_cast<unsigned long>(nowMs - e.timestampMs),
+        static_cast<double>(e.value));
+      if (!append(line, n)) {
+        break;
+      }
+    }
+    cursor.offset++;
+  }
+
+  return len;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Position in a paged formatReadings() walk; start from a default-constructed cursor.
+struct ReadingCacheCursor {
+  uint8_t stage = 0;   // 0 = header lines, 1 = readings, 2 = done
+  uint8_t sensor = 0;
+  uint8_t offset = 0;
+};
+
+// Fixed-size RAM ring of the most recent readings per sensor, served from the board's web
+// server. Every record() gets a cache-wide sequence number so clients can ask for
+// "everything after seq N" and poll cheaply.
+class ReadingCache {
+ public:
+  static const uint8_t kMaxSensors = 8;
+  static const uint8_t kDepth = 32;  // readings kept per sensor
+
+  ReadingCache();
+
+  // Distinguishes sequence numbers across reboots; set once in setup()
+  void setBootId(uint32_t bootId) { bootId_ = bootId; }
+  uint32_t bootId() const { return bootId_; }
+
+  // `name` must outlive the cache (sensor names are compile-time constants).
+  // Readings for an unknown name claim a new slot; they are dropped once all slots are used.
+  void record(const char* name, uint32_t timestampMs, float value);
+
+  uint32_t latestSeq() const { return latestSeq_; }
+
+  // Compact CSV, written page by page so large responses can be streamed:
+  //   latest,<seq>,<boot id hex>
+  //   sensors,<name 0>,<name 1>,...
+  //   <seq>,<sensor index>,<age ms>,<value>     (one line per reading with seq > sinceSeq)
+  // Fills `out` with whole lines only and returns the length; 0 means the walk is finished.
+  // `cap` must fit the two header lines (a 256-byte page is plenty).
+  size_t formatReadings(char* out, size_t cap, uint32_t sinceSeq, uint32_t nowMs, ReadingCacheCursor& cursor) const;
+
+ private:
+  struct Entry {
+    uint32_t seq;
+    uint32_t timestampMs;
+    float value;
+  };
+
+  struct SensorRing {
+    const char* name;
+    uint8_t head;   // next write position
+    uint8_t count;
+    Entry entries[kDepth];
+  };
+
+  int8_t slotFor(const char* name);
+
+  SensorRing sensors_[kMaxSensors];
+  uint8_t sensorCount_;
+  uint32_t latestSeq_;
+  uint32_t bootId_;
+};
@@ -0,0 +1,22 @@
+#include "reading_payload.h"
+
+#include <ArduinoJson.h>
+
+size_t buildReadingPayload(char* out, size_t cap, const char* sensor, float value, float calibrated,
+                           const char* device, uint32_t seq) {
+  // Use StaticJsonDocument; it's deprecated but still supported in this ArduinoJson version.
+  // The replacement JsonDocument type in v7 doesn't take a capacity in the constructor.
+  StaticJsonDocument<128> doc;
+  doc["sensor"] = sensor;
+  doc["value"] = value;
+  if (!isnan(calibrated)) {
+    doc["calibrated"] = calibrated;
+  }
+  if (device) {
+    doc["device"] = device;
+    doc["seq"] = seq;
+  }
+
+  size_t n = serializeJson(doc, out, cap);
+  return (n == 0 || n >= cap) ? 0 : n;
+}
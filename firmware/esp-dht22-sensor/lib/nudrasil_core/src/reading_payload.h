@@ -0,0 +1,13 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Serializes one reading as the JSON body for POST api/sensor:
+//   {"sensor":"<name>","value":<v>[,"calibrated":<c>][,"device":"<id>","seq":<n>]}
+// `calibrated` is only included when it is not NaN (moisture sensors with a calibration);
+// device and seq (the server's dedupe key) only when `device` is set.
+// Returns the payload length, or 0 if it did not fit in `cap` bytes.
+size_t buildReadingPayload(char* out, size_t cap, const char* sensor, float value, float calibrated = NAN,
+                           const char* device = nullptr, uint32_t seq = 0);
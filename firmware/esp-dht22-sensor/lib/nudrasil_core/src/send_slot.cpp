@@ -0,0 +1,36 @@
+#include "send_slot.h"
+
+uint32_t fnv1a32(const char* text) {
+  uint32_t hash = 2166136261u;
+  for (const char* p = text; *p; p++) {
+    hash ^= static_cast<uint8_t>(*p);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+uint32_t sendSlotOffsetMs(const char* deviceId, uint32_t intervalMs) {
+  return intervalMs ? fnv1a32(deviceId) % intervalMs : 0;
+}
+
+uint32_t msUntilSendSlot(uint32_t nowMs, uint32_t intervalMs, uint32_t slotMs) {
+  if (intervalMs == 0) {
+    return 0;
+  }
+  uint32_t phase = nowMs % intervalMs;
+  slotMs %= intervalMs;
+  return (slotMs >= phase) ? slotMs - phase : intervalMs - phase + slotMs;
+}
+
+uint32_t backoffWithJitterMs(uint8_t attempt, uint32_t baseMs, uint32_t capMs, uint32_t randomValue) {
+  uint32_t delayMs = baseMs;
+  for (uint8_t i = 1; i < attempt && delayMs < capMs; i++) {
+    delayMs *= 2;
+  }
+  if (delayMs > capMs) {
+    delayMs = capMs;
+  }
+
+  uint32_t half = delayMs / 2;
+  return half + randomValue % (delayMs - half + 1);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// Fleet-aware timing. Boards that boot together (power blip, router restart) would otherwise
+// post in lockstep; each board instead sends at its own offset within the interval, and
+// retries/reconnects back off with bounded random jitter.
+
+// FNV-1a; stable across builds so a board keeps its slot
+uint32_t fnv1a32(const char* text);
+
+// Deterministic offset in [0, intervalMs) derived from the device id
+uint32_t sendSlotOffsetMs(const char* deviceId, uint32_t intervalMs);
+
+// Milliseconds from `nowMs` until the next time millis() % intervalMs == slotMs (0 if now)
+uint32_t msUntilSendSlot(uint32_t nowMs, uint32_t intervalMs, uint32_t slotMs);
+
+// Retry delay for the 1-based `attempt`: exponential from baseMs, capped at capMs, then
+// "equal jitter" (half fixed, half random) so retries from many boards spread out.
+// `randomValue` is any uniformly random 32-bit number.
+uint32_t backoffWithJitterMs(uint8_t attempt, uint32_t baseMs, uint32_t capMs, uint32_t randomValue);
+
+// baseMs plus up to maxJitterMs of random delay
+inline uint32_t withJitterMs(uint32_t baseMs, uint32_t maxJitterMs, uint32_t randomValue) {
+  return baseMs + (maxJitterMs ? randomValue % (maxJitterMs + 1) : 0);
+}
@@ -0,0 +1,62 @@
+#include "sensor_math.h"
+
+bool buildCalibrationCurve(CalibrationCurve& curve, const float* counts, const float* percents, uint8_t n) {
+  curve.pointCount = 0;
+  if (n < 2 || n > CalibrationCurve::kMaxPoints) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < n; i++) {
+    // Negated checks also reject NaN
+    if (!(counts[i] >= 0.0f && counts[i] <= CalibrationCurve::kMaxCounts) ||
+        !(percents[i] >= 0.0f && percents[i] <= 100.0f)) {
+      return false;
+    }
+
+    curve.counts[i] = static_cast<int32_t>(lroundf(counts[i]));
+    curve.percentQ8[i] = static_cast<int32_t>(lroundf(percents[i] * 256.0f));
+    if (i > 0 && curve.counts[i] <= curve.counts[i - 1]) {
+      return false;
+    }
+  }
+
+  curve.pointCount = n;
+  return true;
+}
+
+bool buildTwoPointCurve(CalibrationCurve& curve, float wetCounts, float dryCounts) {
+  const float counts[] = { wetCounts, dryCounts };
+  const float percents[] = { 100.0f, 0.0f };
+  return buildCalibrationCurve(curve, counts, percents, 2);
+}
+
+int32_t countsToMoistureQ8(const CalibrationCurve& curve, int32_t counts) {
+  if (curve.pointCount == 0) {
+    return 0;
+  }
+  uint8_t last = curve.pointCount - 1;
+  if (counts <= curve.counts[0]) {
+    return curve.percentQ8[0];
+  }
+  if (counts >= curve.counts[last]) {
+    return curve.percentQ8[last];
+  }
+
+  uint8_t i = 1;
+  while (counts > curve.counts[i]) {
+    i++;
+  }
+
+  int32_t c0 = curve.counts[i - 1];
+  int32_t c1 = curve.counts[i];
+  int32_t p0 = curve.percentQ8[i - 1];
+  int32_t p1 = curve.percentQ8[i];
+
+  // buildCalibrationCurve() bounds points to 0..32767 counts and 0..100 %, so the worst case
+  // |(counts - c0) * (p1 - p0)| is 32767 * 25600, well inside int32
+  int32_t num = (counts - c0) * (p1 - p0);
+  int32_t den = c1 - c0;
+  // Floor division (den > 0); rounding here as well would round twice
+  int32_t step = (num >= 0) ? num / den : -((-num + den - 1) / den);
+  return p0 + step;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// TSL2561 reports 0 lux when the read failed or the sensor saturated; -1 marks "no reading".
+inline int luxToReading(float lux) {
+  return (lux > 0.0f) ? static_cast<int>(lux) : -1;
+}
+
+// DHT22 returns NaN on a failed read
+inline bool isValidReading(float value) {
+  return !isnan(value);
+}
+
+// Raw ADS1115 counts are uploaded as-is (see src/readme.md for reference points)
+inline float moistureCountsToValue(int counts) {
+  return static_cast<float>(counts);
+}
+
+// Piecewise-linear counts -> moisture % table. Percent is kept in Q8 fixed point so the
+// per-reading conversion is integer-only (the ESP8266 has no FPU).
+struct CalibrationCurve {
+  static const uint8_t kMaxPoints = 6;
+  static const int32_t kMaxCounts = 32767;  // ADS1115 single-ended full scale
+
+  uint8_t pointCount;
+  int32_t counts[kMaxPoints];     // strictly ascending
+  int32_t percentQ8[kMaxPoints];  // percent * 256
+};
+
+// Builds a curve from (counts, percent) pairs given in strictly increasing counts order.
+// Returns false (and leaves the curve empty) if there are fewer than 2 points, too many,
+// counts outside 0..kMaxCounts, percents outside 0..100, or counts that do not increase.
+bool buildCalibrationCurve(CalibrationCurve& curve, const float* counts, const float* percents, uint8_t n);
+
+// Two-point curve from the sensors table calibration: `wetCounts` (min) is 100%, `dryCounts` (max) is 0%.
+bool buildTwoPointCurve(CalibrationCurve& curve, float wetCounts, float dryCounts);
+
+// Clamps to the table ends and interpolates between neighbouring points. The result is floored
+// to Q8 so moistureQ8ToPercent() rounds the exact value once. Returns 0 for an empty curve.
+int32_t countsToMoistureQ8(const CalibrationCurve& curve, int32_t counts);
+
+// Rounds half up, matching calculateMoisturePercent() in the dashboard
+inline int moistureQ8ToPercent(int32_t percentQ8) {
+  return static_cast<int>((percentQ8 + 128) >> 8);
+}
@@ -0,0 +1,52 @@
+#include "status_report.h"
+
+#include <stdio.h>
+
+static size_t clampFormatted(int n, size_t cap) {
+  if (n < 0 || cap == 0) {
+    return 0;
+  }
+  return (static_cast<size_t>(n) >= cap) ? cap - 1 : static_cast<size_t>(n);
+}
+
+size_t formatStatusJson(char* out, size_t cap, const StatusSnapshot& s) {
+  int n = snprintf(out, cap,
+    "{\"status\":\"%s\",\"wifi\":\"%s\",\"ip\":\"%s\",\"rssi\":%ld,\"uptime\":%lu,"
+    "\"device_id\":\"%s\",\"firmware\":\"%s\",\"server_ip\":\"%s\",\"server_port\":%d,"
+    "\"free_heap\":%lu,\"reset_reason\":\"%s\",\"last_post_age_sec\":%lu,"
+    "\"last_wifi_change_age_sec\":%lu}",
+    s.wifiConnected ? "healthy" : "unhealthy",
+    s.wifiConnected ? "connected" : "disconnected",
+    s.ip,
+    static_cast<long>(s.rssi),
+    static_cast<unsigned long>(s.uptimeSec),
+    s.deviceId,
+    s.firmwareVersion,
+    s.serverIp,
+    s.serverPort,
+    static_cast<unsigned long>(s.freeHeap),
+    s.resetReason,
+    static_cast<unsigned long>(s.lastPostAgeSec),
+    static_cast<unsigned long>(s.lastWiFiChangeSec));
+  return clampFormatted(n, cap);
+}
+
+size_t formatStatusText(char* out, size_t cap, const StatusSnapshot& s) {
+  int n;
+  if (s.serverIp[0] == '\0') {
+    n = snprintf(out, cap,
+      "ESP8266 Sensor Node\nDevice ID: %s\nIP: %s\nWiFi: %s\nRSSI: %ld dBm\n"
+      "Uptime: %lu seconds\nFreeHeap: %lu\nResetReason: %s\nServer: <unset>",
+      s.deviceId, s.ip, s.wifiConnected ? "Connected" : "Disconnected",
+      static_cast<long>(s.rssi), static_cast<unsigned long>(s.uptimeSec),
+      static_cast<unsigned long>(s.freeHeap), s.resetReason);
+  } else {
+    n = snprintf(out, cap,
+      "ESP8266 Sensor Node\nDevice ID: %s\nIP: %s\nWiFi: %s\nRSSI: %ld dBm\n"
+      "Uptime: %lu seconds\nFreeHeap: %lu\nResetReason: %s\nServer: %s:%d",
+      s.deviceId, s.ip, s.wifiConnected ? "Connected" : "Disconnected",
+      static_cast<long>(s.rssi), static_cast<unsigned long>(s.uptimeSec),
+      static_cast<unsigned long>(s.freeHeap), s.resetReason, s.serverIp, s.serverPort);
+  }
+  return clampFormatted(n, cap);
+}
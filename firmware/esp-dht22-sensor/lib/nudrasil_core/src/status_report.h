@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Everything the /status and / handlers report, captured once per request.
+// Strings are borrowed; the caller keeps them alive while formatting.
+struct StatusSnapshot {
+  bool wifiConnected;
+  const char* ip;
+  int32_t rssi;
+  uint32_t uptimeSec;
+  const char* deviceId;
+  const char* firmwareVersion;
+  const char* serverIp;
+  int serverPort;
+  uint32_t freeHeap;
+  const char* resetReason;
+  uint32_t lastPostAgeSec;
+  uint32_t lastWiFiChangeSec;
+};
+
+// Both return the formatted length (truncated to cap - 1 if the buffer is too small).
+size_t formatStatusJson(char* out, size_t cap, const StatusSnapshot& s);
+size_t formatStatusText(char* out, size_t cap, const StatusSnapshot& s);
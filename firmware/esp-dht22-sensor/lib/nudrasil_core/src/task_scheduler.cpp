@@ -0,0 +1,149 @@
+#include "task_scheduler.h"
+
+TaskScheduler::TaskScheduler() : taskCount_(0), heapSize_(0) {}
+
+uint8_t TaskScheduler::add(const char* name, TaskCallback callback, uint32_t intervalMs) {
+  if (taskCount_ >= kMaxTasks) {
+    return kInvalidTask;
+  }
+  uint8_t id = taskCount_++;
+  tasks_[id] = { name, callback, intervalMs, 0, kInvalidTask };
+  return id;
+}
+
+void TaskScheduler::schedule(uint8_t id, uint32_t now, uint32_t delayMs) {
+  if (id >= taskCount_) {
+    return;
+  }
+  Task& task = tasks_[id];
+  task.dueMs = now + delayMs;
+
+  if (task.heapPos == kInvalidTask) {
+    place(heapSize_++, id);
+    siftUp(task.heapPos);
+  } else {
+    // Due time may have moved either way
+    siftUp(task.heapPos);
+    siftDown(task.heapPos);
+  }
+}
+
+void TaskScheduler::cancel(uint8_t id) {
+  if (id < taskCount_ && tasks_[id].heapPos != kInvalidTask) {
+    removeAt(tasks_[id].heapPos);
+  }
+}
+
+bool TaskScheduler::isScheduled(uint8_t id) const {
+  return id < taskCount_ && tasks_[id].heapPos != kInvalidTask;
+}
+
+void TaskScheduler::setInterval(uint8_t id, uint32_t intervalMs) {
+  if (id < taskCount_) {
+    tasks_[id].intervalMs = intervalMs;
+  }
+}
+
+uint32_t TaskScheduler::interval(uint8_t id) const {
+  return id < taskCount_ ? tasks_[id].intervalMs : 0;
+}
+
+const char* TaskScheduler::name(uint8_t id) const {
+  return id < taskCount_ ? tasks_[id].name : "";
+}
+
+uint8_t TaskScheduler::runDue(uint32_t now) {
+  uint8_t ran = 0;
+
+  // Bounded so a task that keeps re-arming itself with no delay cannot starve loop()
+  while (heapSize_ > 0 && ran < kMaxTasks) {
+    uint8_t id = heap_[0];
+    Task& task = tasks_[id];
+    if (static_cast<int32_t>(task.dueMs - now) > 0) {
+      break;
+    }
+
+    removeAt(0);
+    if (task.intervalMs > 0) {
+      // Keep the cadence anchored to the original due time; if periods were missed, skip to
+      // the next one still ahead instead of running back to back to catch up
+      uint32_t late = now - task.dueMs;
+      schedule(id, task.dueMs, task.intervalMs * (late / task.intervalMs + 1));
+    }
+
+    task.callback();
+    ran++;
+  }
+
+  return ran;
+}
+
+uint32_t TaskScheduler::msUntilNext(uint32_t now, uint32_t maxWaitMs) const {
+  if (heapSize_ == 0) {
+    return maxWaitMs;
+  }
+  int32_t untilDue = static_cast<int32_t>(tasks_[heap_[0]].dueMs - now);
+  if (untilDue <= 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>(untilDue) < maxWaitMs ? static_cast<uint32_t>(untilDue) : maxWaitMs;
+}
+
+bool TaskScheduler::earlier(uint8_t a, uint8_t b) const {
+  return static_cast<int32_t>(tasks_[heap_[a]].dueMs - tasks_[heap_[b]].dueMs) < 0;
+}
+
+void TaskScheduler::place(uint8_t pos, uint8_t id) {
+  heap_[pos] = id;
+  tasks_[id].heapPos = pos;
+}
+
+void TaskScheduler::siftUp(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (!earlier(pos, parent)) {
+      break;
+    }
+    uint8_t id = heap_[pos];
+    place(pos, heap_[parent]);
+    place(parent, id);
+    pos = parent;
+  }
+}
+
+void TaskScheduler::siftDown(uint8_t pos) {
+  while (true) {
+    uint8_t left = 2 * pos + 1;
+    uint8_t right = left + 1;
+    uint8_t smallest = pos;
+
+    if (left < heapSize_ && earlier(left, smallest)) {
+      smallest = left;
+    }
+    if (right < heapSize_ && earlier(right, smallest)) {
+      smallest = right;
+    }
+    if (smallest == pos) {
+      break;
+    }
+
+    uint8_t id = heap_[pos];
+    place(pos, heap_[smallest]);
+    place(smallest, id);
+    pos = smallest;
+  }
+}
+
+void TaskScheduler::removeAt(uint8_t pos) {
+  uint8_t removed = heap_[pos];
+  heapSize_--;
+
+  if (pos != heapSize_) {
+    uint8_t moved = heap_[heapSize_];
+    place(pos, moved);
+    siftUp(pos);
+    siftDown(tasks_[moved].heapPos);
+  }
+
+  tasks_[removed].heapPos = kInvalidTask;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef void (*TaskCallback)();
+
+// Fixed-capacity min-heap of timed tasks, keyed by due time (millis()).
+//
+// A task with a non-zero interval re-arms itself every time it runs, one interval after its
+// previous due time (not after when it actually ran), so callback latency does not shift the
+// cadence; missed periods are skipped. A task with interval 0 is a one-shot deadline that
+// stays idle until schedule() arms it. Due times are compared
+// as signed differences, so millis() wraparound is handled as long as nothing is scheduled
+// more than ~24 days out.
+class TaskScheduler {
+ public:
+  static const uint8_t kMaxTasks = 12;
+  static const uint8_t kInvalidTask = 0xFF;
+
+  TaskScheduler();
+
+  // Registers a task (idle until scheduled). Returns kInvalidTask when full.
+  uint8_t add(const char* name, TaskCallback callback, uint32_t intervalMs);
+
+  // Arms (or re-arms) a task to run `delayMs` after `now`
+  void schedule(uint8_t id, uint32_t now, uint32_t delayMs);
+  void cancel(uint8_t id);
+  bool isScheduled(uint8_t id) const;
+
+  // Takes effect the next time the task re-arms itself
+  void setInterval(uint8_t id, uint32_t intervalMs);
+  uint32_t interval(uint8_t id) const;
+
+  // Runs every task that is due at `now`. Periodic tasks are re-armed before their callback
+  // runs, so a callback may freely reschedule or cancel itself. Returns the number run.
+  uint8_t runDue(uint32_t now);
+
+  // Milliseconds until the earliest armed task, capped at `maxWaitMs`
+  uint32_t msUntilNext(uint32_t now, uint32_t maxWaitMs) const;
+
+  const char* name(uint8_t id) const;
+
+ private:
+  struct Task {
+    const char* name;
+    TaskCallback callback;
+    uint32_t intervalMs;
+    uint32_t dueMs;
+    uint8_t heapPos;  // kInvalidTask when not armed
+  };
+
+  bool earlier(uint8_t a, uint8_t b) const;
+  void place(uint8_t pos, uint8_t id);
+  void siftUp(uint8_t pos);
+  void siftDown(uint8_t pos);
+  void removeAt(uint8_t pos);
+
+  Task tasks_[kMaxTasks];
+  uint8_t taskCount_;
+  uint8_t heap_[kMaxTasks];
+  uint8_t heapSize_;
+};
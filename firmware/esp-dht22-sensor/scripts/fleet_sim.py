@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Fleet upload simulator: peak POST api/sensor rate after the whole fleet reboots together.
+
+Compares the old timing (first send one full interval after boot, fixed retry delays) with
+send slots (FNV-1a of DEVICE_ID, same as lib/nudrasil_core/send_slot.cpp) and jittered retries.
+
+Each cycle starts up to 2 * --latency-ms late (loop() busy with a probe, config fetch or
+backlog flush). "re-arm from run" is the old scheduler, which re-armed the next cycle from
+when this one ran, so lateness accumulated and boards drifted off their slots; "anchored"
+re-arms from the due time (TaskScheduler::runDue), so lateness never carries over.
+
+  python3 scripts/fleet_sim.py --boards 40 --sensors 7 --outage 90 --hours 24
+"""
+
+import argparse
+import random
+from collections import Counter
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+
+def fnv1a32(text):
+    h = FNV_OFFSET
+    for b in text.encode():
+        h ^= b
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def backoff_with_jitter_ms(attempt, base_ms, cap_ms, rnd):
+    delay = base_ms
+    for _ in range(1, attempt):
+        if delay >= cap_ms:
+            break
+        delay *= 2
+    delay = min(delay, cap_ms)
+    half = delay // 2
+    return half + rnd.randrange(delay - half + 1)
+
+
+def simulate(args, slotted, anchored, seed):
+    rnd = random.Random(seed)
+    interval_ms = args.interval * 1000
+    horizon_ms = args.hours * 3600 * 1000
+    outage_end_ms = args.outage * 1000
+    legacy_delays = [1500] * 6  # old fixed delay after a failed POST
+
+    requests = Counter()
+
+    for board in range(args.boards):
+        device_id = "board%d" % (board + 1)
+        # Boards come back within a couple of seconds of each other after a power blip
+        boot_ms = rnd.randrange(0, 2000)
+
+        if slotted:
+            slot = fnv1a32(device_id) % interval_ms
+            first = slot if slot >= boot_ms else slot + interval_ms
+        else:
+            first = boot_ms + interval_ms
+
+        due = first
+        while due < horizon_ms:
+            t_cycle = due + rnd.randrange(2 * args.latency_ms + 1)
+            t = t_cycle
+            for _sensor in range(args.sensors):
+                for attempt in range(1, 7):
+                    requests[t // 1000] += 1
+                    t += args.request_ms
+                    if t >= outage_end_ms:
+                        break
+                    if slotted:
+                        t += backoff_with_jitter_ms(attempt, 750, 3000, rnd)
+                    else:
+                        t += legacy_delays[attempt - 1]
+            due = (due if anchored else t_cycle) + interval_ms
+
+    return requests
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--boards", type=int, default=40)
+    parser.add_argument("--sensors", type=int, default=7, help="readings posted per cycle")
+    parser.add_argument("--interval", type=int, default=600, help="send interval in seconds")
+    parser.add_argument("--outage", type=int, default=0, help="seconds after boot the server rejects posts")
+    parser.add_argument("--request-ms", type=int, default=150, help="duration of one POST")
+    parser.add_argument("--latency-ms", type=int, default=250, help="mean lateness of a cycle's start")
+    parser.add_argument("--hours", type=float, default=1.0)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    modes = (
+        ("fixed interval", False, False),
+        ("slots, re-arm from run", True, False),
+        ("slots, anchored", True, True),
+    )
+    for label, slotted, anchored in modes:
+        requests = simulate(args, slotted, anchored, args.seed)
+        total = sum(requests.values())
+        peak_sec, peak = max(requests.items(), key=lambda kv: kv[1])
+        # Seconds where more than one board's cycle overlaps
+        crowded = sum(1 for n in requests.values() if n > args.sensors)
+        print("%-24s peak %4d req/s at t=%ds, %ds above %d req/s, %d requests total"
+              % (label, peak, peak_sec, crowded, args.sensors, total))
+
+
+if __name__ == "__main__":
+    main()
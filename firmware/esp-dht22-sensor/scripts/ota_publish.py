@@ -0,0 +1,69 @@
+# PlatformIO extra script for pull-based OTA.
+#
+# - Injects FIRMWARE_VERSION / OTA_CHANNEL defines from `custom_fw_version` and the env name.
+# - After firmware.bin is linked, writes a gzip-compressed image and a manifest to
+#   ota/<env>/ so the folder can be copied to the app's FIRMWARE_DIR (or served locally with
+#   `python3 -m http.server` for testing).
+# - Boards only install a higher version. Set `custom_ota_allow_downgrade = yes` to publish a
+#   rollback; the manifest then carries "allowDowngrade": true.
+
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+
+Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+
+pioenv = env["PIOENV"]
+fw_version = env.GetProjectOption("custom_fw_version", "dev")
+allow_downgrade = env.GetProjectOption("custom_ota_allow_downgrade", "no").lower() in ("yes", "true", "1")
+
+# Must match parseFirmwareVersion() in lib/nudrasil_core/src/firmware_version.cpp
+if not re.fullmatch(r"\d+(\.\d+){0,3}", fw_version):
+    print("Warning: custom_fw_version %r is not dotted numeric; boards will ignore this image" % fw_version)
+
+env.Append(
+    CPPDEFINES=[
+        ("FIRMWARE_VERSION", env.StringifyMacro(fw_version)),
+        ("OTA_CHANNEL", env.StringifyMacro(pioenv)),
+    ]
+)
+
+
+def publish_ota_image(source, target, env):
+    bin_path = str(target[0])
+    out_dir = os.path.join(env["PROJECT_DIR"], "ota", pioenv)
+    os.makedirs(out_dir, exist_ok=True)
+
+    gz_name = "firmware.bin.gz"
+    gz_path = os.path.join(out_dir, gz_name)
+
+    # mtime=0 keeps the output reproducible for identical builds
+    with open(bin_path, "rb") as src, open(gz_path, "wb") as raw:
+        with gzip.GzipFile(filename="", mode="wb", fileobj=raw, compresslevel=9, mtime=0) as dst:
+            shutil.copyfileobj(src, dst)
+
+    with open(gz_path, "rb") as f:
+        data = f.read()
+
+    manifest = {
+        "version": fw_version,
+        "md5": hashlib.md5(data).hexdigest(),
+        "size": len(data),
+        "file": gz_name,
+    }
+    if allow_downgrade:
+        manifest["allowDowngrade"] = True
+
+    with open(os.path.join(out_dir, "manifest.json"), "w") as f:
+        json.dump(manifest, f, indent=2)
+
+    print(
+        "OTA image: %s (%d bytes, from %d) version %s"
+        % (gz_path, len(data), os.path.getsize(bin_path), fw_version)
+    )
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.bin", publish_ota_image)
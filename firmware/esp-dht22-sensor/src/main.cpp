@@ -3,11 +3,24 @@
 #include <ESP8266WebServer.h>
 #include <ArduinoJson.h>
 #include <ArduinoOTA.h>
+#include <Updater.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
 #include <Wire.h>
 #include <Adafruit_ADS1X15.h>
 #include <Adafruit_TSL2561_U.h>
 #include "DHT.h"
 #include "secrets.h"
+#include "device_config.h"
+#include "firmware_version.h"
+#include "http_endpoint.h"
+#include "reading_backlog.h"
+#include "reading_cache.h"
+#include "reading_payload.h"
+#include "send_slot.h"
+#include "sensor_math.h"
+#include "status_report.h"
+#include "task_scheduler.h"
 
 // --- TSL2561 Setup ---
 #if ENABLE_LUX_SENSOR
@@ -46,46 +59,151 @@ MoistureSensorConfig moistureSensors[] = {
   , { MOISTURE_SENSOR_4_NAME, MOISTURE_SENSOR_4_CHANNEL }
   #endif
 };
+
+// --- Moisture Calibration (cached from config fetch) ---
+CalibrationCurve moistureCurves[MOISTURE_SENSOR_COUNT];
+bool moistureCalibrated[MOISTURE_SENSOR_COUNT] = { false };
 #endif
 
 // --- Config ---
 String serverIp = "";
 int serverPort = 0;
-bool configNeedsFetch = false;  // Fetch config in main loop
-
-// --- Timers ---
-unsigned long lastSent = 0;
-const unsigned long sendInterval = (60UL * 1000UL) * 10UL;  // 10 minutes
-
-unsigned long lastConnectivityCheck = 0;
-const unsigned long connectivityCheckInterval = 10000;
 
-unsigned long lastConfigFetchAttempt = 0;
+// --- Server Endpoint Cache ---
+// Uploads and probes connect straight to an IP: the config's ip:port when we have one,
+// otherwise a cached DNS answer for the SERVER_URL host. Host is always taken from SERVER_URL.
+HttpUrl serverUrl;
+bool serverUrlValid = false;
+IPAddress cachedServerAddr;
+bool cachedServerAddrValid = false;
+unsigned long cachedServerAddrAtMs = 0;
+const unsigned long dnsCacheTtlMs = 10UL * 60UL * 1000UL; // 10 minutes
+// After the configured ip:port refuses a connection, go through DNS for a while
+unsigned long configEndpointFailedAtMs = 0;
+bool configEndpointFailed = false;
+const unsigned long configEndpointHoldoffMs = 5UL * 60UL * 1000UL; // 5 minutes
+
+// --- Intervals ---
+// Firmware defaults; `config.intervals` in the device config overrides them (within bounds)
+// and is re-read on every config revalidation.
+const DeviceIntervals firmwareIntervals = defaultDeviceIntervals();
+unsigned long sendInterval = firmwareIntervals.sendMs;  // 10 minutes
+unsigned long connectivityCheckInterval = firmwareIntervals.connectivityCheckMs;  // 10 seconds
 const unsigned long configFetchRetryInterval = 5000;  // Retry every 5 seconds if needed
+unsigned long probeIntervalMs = firmwareIntervals.probeMs; // 1 minute
+unsigned long configRefreshInterval = firmwareIntervals.configRefreshMs; // 15 minutes
+
+// --- Fleet Send Slots ---
+// Each board uploads at its own offset within sendInterval (from DEVICE_ID unless the device
+// config sets sendSlotMs) so a fleet that reboots together doesn't post in lockstep.
+unsigned long sendSlotMs = 0;
+const unsigned long postRetryBaseMs = 750;
+const unsigned long postRetryCapMs = 3000;
+// Uploads carry (device, seq) and the server drops repeats, so a slow POST is retried early
+const unsigned long postTimeoutMs = 2000;
+const unsigned long configFetchJitterMs = 2500;
+const unsigned long reconnectJitterMs = 15000;
 
 // --- Health/Recovery ---
 unsigned long lastSuccessfulPostMs = 0;
-const unsigned long maxNoPostBeforeRestartMs = 15UL * 60UL * 1000UL; // 15 minutes
-const unsigned long maxWiFiDownBeforeRestartMs = 8UL * 60UL * 1000UL; // 8 minutes
-const unsigned long maxConfigFetchFailBeforeRestartMs = 2UL * 60UL * 1000UL; // 2 minutes
+unsigned long maxNoPostBeforeRestartMs = firmwareIntervals.maxNoPostMs; // 15 minutes
+unsigned long maxWiFiDownBeforeRestartMs = firmwareIntervals.maxWiFiDownMs; // 8 minutes
+unsigned long maxConfigFetchFailBeforeRestartMs = firmwareIntervals.maxConfigFailMs; // 2 minutes
 
-// --- Config fetch failure tracking ---
-unsigned long firstConfigFetchFailureMs = 0; // Track when config fetch started failing
-
-// --- WiFi transition tracking ---
-static wl_status_t lastWiFiStatus = WL_DISCONNECTED;
-static unsigned long lastWiFiTransitionMs = 0;
-static unsigned long lastReconnectTimeMs = 0;
+// --- WiFi state (updated from events, not polled) ---
+volatile bool wifiEventPending = false;
+bool wifiUp = false;
+unsigned long lastWiFiTransitionMs = 0;
+unsigned long lastReconnectTimeMs = 0;
 
 // --- Manual reconnect backoff ---
 unsigned long lastManualReconnectAttemptMs = 0;
 const unsigned long reconnectBackoffMs = 60000; // 60 seconds between manual attempts
+unsigned long reconnectWaitMs = reconnectBackoffMs; // backoff plus this attempt's jitter
 
-// --- Probe logging (non-blocking) ---
-unsigned long lastProbeAttemptMs = 0;
-const unsigned long probeIntervalMs = 60000; // 1 minute
+// --- Probe logging ---
 unsigned long lastProbeFailLogMs = 0;
 
+// --- Recent Readings Cache (served at /readings) ---
+ReadingCache readingCache;
+
+// --- Reading Sequence (persisted across restarts) ---
+// Every reading gets the next per-device seq; the server ignores a (device, seq) it already
+// stored, so retries can't duplicate rows. Flash only holds a high-water mark reserved a block
+// at a time: after a restart the board skips the rest of the block instead of writing flash
+// on every reading.
+struct SequenceRecord {
+  uint32_t magic;
+  uint32_t reservedThrough;
+  uint32_t check;  // ~reservedThrough
+};
+const uint32_t sequenceRecordMagic = 0x4E534551; // "NSEQ"
+const uint32_t sequenceBlock = 256;
+uint32_t nextReadingSeq = 0;
+uint32_t readingSeqReservedThrough = 0;
+
+// --- Reading Backlog (replayed in bulk to api/sensor/bulk) ---
+// Readings that failed to post or were taken while WiFi was down; while any are waiting, new
+// readings queue behind them. Saved to LittleFS whenever it changes so a restart keeps it.
+ReadingBacklog backlog;
+const char* backlogPath = "/backlog.bin";
+const char* backlogTempPath = "/backlog.tmp";
+bool backlogStorageReady = false;
+uint8_t backlogChunk[1200];
+uint8_t backlogScratch[1024];  // uncompressed chunk body
+const uint16_t maxReadingsPerChunk = 320;
+const uint8_t maxChunksPerFlush = 8;
+const unsigned long backlogRetryBaseMs = 30000;
+const unsigned long backlogRetryCapMs = 10UL * 60UL * 1000UL; // 10 minutes
+uint8_t backlogRetryAttempt = 0;
+
+// --- Power ---
+// The radio stays always on (WIFI_NONE_SLEEP) by default. Build with -DENABLE_MODEM_SLEEP=1
+// to let it doze between DTIM beacons while loop() waits for the next task.
+#ifndef ENABLE_MODEM_SLEEP
+#define ENABLE_MODEM_SLEEP 0
+#endif
+// Upper bound on idle waits so the web server and ArduinoOTA stay responsive
+const unsigned long maxIdleWaitMs = 50;
+
+// --- Scheduler ---
+// Every periodic job and failsafe deadline lives here; loop() sleeps until the earliest one.
+TaskScheduler scheduler;
+uint8_t sensorCycleTask = TaskScheduler::kInvalidTask;
+uint8_t connectivityTask = TaskScheduler::kInvalidTask;
+uint8_t probeTask = TaskScheduler::kInvalidTask;
+uint8_t configFetchTask = TaskScheduler::kInvalidTask;
+uint8_t configRefreshTask = TaskScheduler::kInvalidTask;
+uint8_t otaCheckTask = TaskScheduler::kInvalidTask;
+uint8_t backlogFlushTask = TaskScheduler::kInvalidTask;
+uint8_t noPostDeadline = TaskScheduler::kInvalidTask;
+uint8_t wifiDownDeadline = TaskScheduler::kInvalidTask;
+uint8_t configFailDeadline = TaskScheduler::kInvalidTask;
+
+// --- Pull OTA ---
+// FIRMWARE_VERSION and OTA_CHANNEL are injected by scripts/ota_publish.py
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "dev"
+#endif
+#ifndef OTA_CHANNEL
+#define OTA_CHANNEL DEVICE_ID
+#endif
+// Override with -DOTA_BASE_URL=\"http://<host>:<port>/\" to test against a local static file server
+#ifndef OTA_BASE_URL
+#define OTA_BASE_URL SERVER_URL "firmware/"
+#endif
+
+const unsigned long otaCheckInterval = 6UL * 60UL * 60UL * 1000UL; // 6 hours
+
+struct PendingUpdate {
+  bool available;
+  String version;
+  String md5;
+  size_t size;
+  String url;
+};
+PendingUpdate pendingUpdate = { false, "", "", 0, "" };
+
 // --- Debug Mode ---
 const bool debugMode = true;
 template <typename T> void debug(const T& msg) { if (debugMode) Serial.println(msg); }
@@ -93,11 +211,14 @@ template <typename T> void debugInline(const T& msg) { if (debugMode) Serial.pri
 
 // --- Forward Declarations ---
 void fetchServerConfig();
-bool checkConnectivityNonBlocking();
+void maintainWiFiConnection();
 bool postSensorData(float tempC, float humidity, int* moistureValues, int light);
 void runSensorCycle();
+void checkForFirmwareUpdate();
+void applyPendingUpdate();
 
 // --- WiFi Event Handlers ---
+// These run from the SDK event dispatch; they only log and flag the change for loop().
 void onWiFiConnected(const WiFiEventStationModeConnected& evt) {
   debug("WiFi connected to: " + String(evt.ssid));
   debug("Channel: " + String(evt.channel));
@@ -109,106 +230,401 @@ void onWiFiGotIP(const WiFiEventStationModeGotIP& evt) {
   debug("Gateway: " + evt.gw.toString());
   debug("Subnet: " + evt.mask.toString());
   debug("RSSI: " + String(WiFi.RSSI()) + " dBm");
-
-  // Config fetch should happen in main loop
-  if (serverIp == "") {
-    debug("Server config not initialized, will fetch in main loop");
-    configNeedsFetch = true;
-    // Clear failure tracking on WiFi reconnect to give config fetch a fresh chance
-    firstConfigFetchFailureMs = 0;
-  } else {
-    debug("Server config already initialized: " + serverIp + ":" + String(serverPort));
-  }
+  wifiEventPending = true;
 }
 
 void onWiFiDisconnected(const WiFiEventStationModeDisconnected& evt) {
   debug("WiFi disconnected. Reason: " + String(evt.reason));
   debug("Attempting to reconnect...");
+  wifiEventPending = true;
 }
 
-// --- Helper: track WiFi state transitions reliably ---
-void updateWiFiTransitionTracking() {
-  wl_status_t cur = WiFi.status();
-  if (cur != lastWiFiStatus) {
-    lastWiFiTransitionMs = millis();
+// --- Helper: apply WiFi state transitions flagged by the event handlers ---
+void handleWiFiTransition() {
+  if (!wifiEventPending) {
+    return;
+  }
+  wifiEventPending = false;
 
-    if (cur == WL_CONNECTED) {
-      lastReconnectTimeMs = millis();
+  bool up = WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0);
+  if (up == wifiUp) {
+    return;
+  }
+
+  unsigned long now = millis();
+  wifiUp = up;
+  lastWiFiTransitionMs = now;
+
+  if (up) {
+    lastReconnectTimeMs = now;
+    scheduler.cancel(wifiDownDeadline);
+
+    // Config fetch should happen in main loop
+    if (serverIp == "") {
+      debug("Server config not initialized, will fetch in main loop");
+      // Clear failure tracking on WiFi reconnect to give config fetch a fresh chance
+      scheduler.cancel(configFailDeadline);
+      scheduler.schedule(configFetchTask, now, withJitterMs(0, configFetchJitterMs, ESP.random()));
+    } else {
+      debug("Server config already initialized: " + serverIp + ":" + String(serverPort));
     }
 
-    lastWiFiStatus = cur;
+    // Replay readings queued while offline, spread out like reconnects
+    if (!backlog.empty()) {
+      backlogRetryAttempt = 0;
+      scheduler.schedule(backlogFlushTask, now, withJitterMs(1000, reconnectJitterMs, ESP.random()));
+    }
+  } else {
+    scheduler.schedule(wifiDownDeadline, now, maxWiFiDownBeforeRestartMs);
+    // The WiFi-down failsafe covers this now; config failures restart tracking on reconnect
+    scheduler.cancel(configFailDeadline);
+    // We may come back on a different network (and resolver)
+    cachedServerAddrValid = false;
   }
 }
 
-// --- Connectivity Check (non-blocking for sending) ---
-// This function may attempt reconnection, but it does NOT return false just because a probe fails.
-// It returns true only if WiFi is connected at the end, false otherwise.
-bool checkConnectivityNonBlocking() {
-  updateWiFiTransitionTracking();
+// --- WiFi reconnect (backed off) ---
+// Relies on auto-reconnect for most drops; re-issues WiFi.begin at most once per backoff window.
+void maintainWiFiConnection() {
+  if (WiFi.status() == WL_CONNECTED) {
+    return;
+  }
 
   unsigned long now = millis();
-  if (now - lastConnectivityCheck < connectivityCheckInterval) {
-    return WiFi.status() == WL_CONNECTED;
+  // Respect a backoff between manual reconnect attempts to avoid hammering the AP
+  if (now - lastManualReconnectAttemptMs < reconnectWaitMs) {
+    return;
   }
-  lastConnectivityCheck = now;
 
-  if (WiFi.status() != WL_CONNECTED) {
-    // Respect a backoff between manual reconnect attempts to avoid hammering the AP
-    if (now - lastManualReconnectAttemptMs < reconnectBackoffMs) {
-      return false;
+  lastManualReconnectAttemptMs = now;
+  reconnectWaitMs = withJitterMs(reconnectBackoffMs, reconnectJitterMs, ESP.random());
+  debug("WiFi not connected, attempting manual reconnection (backed off)...");
+  debug("Current WiFi status: " + String(WiFi.status()));
+
+  // Disconnect and clear before reconnecting
+  WiFi.disconnect();
+  delay(100);
+
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+}
+
+// --- Scheduled: connectivity check ---
+void runConnectivityCheck() {
+  // Safety net in case an event was missed
+  if ((WiFi.status() == WL_CONNECTED) != wifiUp) {
+    wifiEventPending = true;
+    handleWiFiTransition();
+  }
+
+  if (!wifiUp) {
+    maintainWiFiConnection();
+    return;
+  }
+
+  // Fallback if onWiFiGotIP didn't fire: WiFi has an IP but config was never fetched
+  if (serverIp == "" && !scheduler.isScheduled(configFetchTask)) {
+    debug("WiFi has IP but config not fetched, triggering config fetch");
+    scheduler.cancel(configFailDeadline);
+    scheduler.schedule(configFetchTask, millis(), 0);
+  }
+}
+
+// --- Server connection (resolved endpoint, DNS fallback) ---
+const int kServerConnectFailed = -1;
+const int kServerWriteFailed = -2;
+const int kServerNoResponse = -3;
+
+String serverErrorToString(int code) {
+  switch (code) {
+    case kServerConnectFailed: return "connection failed";
+    case kServerWriteFailed: return "request write failed";
+    case kServerNoResponse: return "no response";
+    default: return "HTTP " + String(code);
+  }
+}
+
+// Looks up the SERVER_URL host, reusing the last answer until it expires
+bool resolveServerHost(IPAddress& out, bool forceRefresh) {
+  unsigned long now = millis();
+  if (!forceRefresh && cachedServerAddrValid && now - cachedServerAddrAtMs < dnsCacheTtlMs) {
+    out = cachedServerAddr;
+    return true;
+  }
+
+  IPAddress resolved;
+  if (!WiFi.hostByName(serverUrl.host, resolved) || !resolved.isSet()) {
+    debug("DNS lookup failed for " + String(serverUrl.host));
+    cachedServerAddrValid = false;
+    return false;
+  }
+
+  if (!cachedServerAddrValid || resolved != cachedServerAddr) {
+    debug("Resolved " + String(serverUrl.host) + " -> " + resolved.toString());
+  }
+  cachedServerAddr = resolved;
+  cachedServerAddrValid = true;
+  cachedServerAddrAtMs = now;
+  out = resolved;
+  return true;
+}
+
+// Configured ip:port first, then the cached DNS answer, then a fresh lookup
+bool connectToServer(WiFiClient& client) {
+  unsigned long now = millis();
+  if (configEndpointFailed && now - configEndpointFailedAtMs >= configEndpointHoldoffMs) {
+    configEndpointFailed = false;
+  }
+
+  IPAddress configAddr;
+  if (!configEndpointFailed && serverPort > 0 && configAddr.fromString(serverIp)) {
+    if (client.connect(configAddr, serverPort)) {
+      return true;
     }
+    debug("Configured endpoint " + serverIp + ":" + String(serverPort) + " unreachable, falling back to DNS");
+    configEndpointFailed = true;
+    configEndpointFailedAtMs = now;
+  }
 
-    lastManualReconnectAttemptMs = now;
-    debug("WiFi not connected, attempting manual reconnection (backed off)...");
-    debug("Current WiFi status: " + String(WiFi.status()));
+  bool hadCachedAddr = cachedServerAddrValid;
+  IPAddress addr;
+  if (resolveServerHost(addr, false) && client.connect(addr, serverUrl.port)) {
+    return true;
+  }
 
-    // Disconnect and clear before reconnecting
-    WiFi.disconnect();
-    delay(100);
-    
-    // Let auto-reconnect handle most cases; just (re)issue WiFi.begin here.
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  // The cached answer may be stale; look it up again once before giving up
+  if (hadCachedAddr && resolveServerHost(addr, true)) {
+    return client.connect(addr, serverUrl.port);
+  }
+  return false;
+}
 
-    // Don't block here; just report current status. Future calls will see if it connected.
-    return WiFi.status() == WL_CONNECTED;
+// One HTTP/1.0 request to SERVER_URL's base path. Returns the HTTP status, or one of the
+// negative kServer* errors. The body (if requested) is whatever arrives before the server closes.
+int serverRequest(const char* method, const char* path, const char* contentType,
+                  const uint8_t* body, size_t len, unsigned long timeoutMs, String* response = nullptr) {
+  if (!serverUrlValid) {
+    return kServerConnectFailed;
   }
 
-  // WiFi is connected. Optionally run a probe, but do not block sending.
-  // Avoid probing immediately after reconnect
-  unsigned long sinceReconnect = millis() - lastReconnectTimeMs;
-  if (sinceReconnect > 5000 && (millis() - lastProbeAttemptMs) > probeIntervalMs) {
-    lastProbeAttemptMs = millis();
-
-    // Probe the server using the same domain as config fetch
-    String probeUrl = String(SERVER_URL) + "api/probe";
-    HTTPClient http;
-    WiFiClient client;
-    http.setTimeout(3000);
-    http.setReuse(false);
-
-    if (http.begin(client, probeUrl)) {
-      int code = http.GET();
-      http.end();
-
-      if (code != 200) {
-        if (millis() - lastProbeFailLogMs > 30000) {
-          debug("Probe failed (HTTP " + String(code) + ") but WiFi is connected; continuing.");
-          lastProbeFailLogMs = millis();
-        }
+  WiFiClient client;
+  client.setTimeout(timeoutMs);
+  if (!connectToServer(client)) {
+    return kServerConnectFailed;
+  }
+
+  char head[256];
+  size_t headLen = buildRequestHead(head, sizeof(head), method, serverUrl, path, DEVICE_SECRET, contentType, len);
+  if (headLen == 0
+      || client.write(reinterpret_cast<const uint8_t*>(head), headLen) != headLen
+      || (len > 0 && client.write(body, len) != len)) {
+    client.stop();
+    return kServerWriteFailed;
+  }
+
+  String statusLine = client.readStringUntil('\n');
+  int status = parseStatusLine(statusLine.c_str());
+  if (status < 0) {
+    client.stop();
+    return kServerNoResponse;
+  }
+
+  if (response) {
+    // Skip headers up to the blank line
+    while (true) {
+      String line = client.readStringUntil('\n');
+      if (line.length() <= 1) {
+        break;
       }
+    }
+    *response = client.readString();
+  }
+
+  client.stop();
+  return status;
+}
+
+// --- Scheduled: server probe (logging only, never blocks sending) ---
+void runConnectivityProbe() {
+  // Avoid probing immediately after reconnect
+  if (!wifiUp || millis() - lastReconnectTimeMs < 5000) {
+    return;
+  }
+
+  // Same endpoint resolution as uploads, so a failing probe means uploads would fail too
+  int code = serverRequest("GET", "api/probe", nullptr, nullptr, 0, 3000);
+  if (code != 200) {
+    if (millis() - lastProbeFailLogMs > 30000) {
+      debug("Probe failed (" + serverErrorToString(code) + ") but WiFi is connected; continuing.");
+      lastProbeFailLogMs = millis();
+    }
+  }
+}
+
+// --- Scheduled: config fetch (one-shot, re-armed on failure) ---
+void runConfigFetch() {
+  if (!wifiUp) {
+    // Picked up again by handleWiFiTransition() once WiFi is back
+    return;
+  }
+  fetchServerConfig();
+}
+
+// --- Scheduled: config revalidation (picks up interval and calibration changes) ---
+void runConfigRefresh() {
+  if (!wifiUp || scheduler.isScheduled(configFetchTask)) {
+    return;
+  }
+  fetchServerConfig();
+}
+
+// --- Scheduled: failsafe deadlines ---
+void onConfigFailDeadline() {
+  debug("Failsafe: config fetch failing for too long (" + String(maxConfigFetchFailBeforeRestartMs / 1000) + "s). Restarting...");
+  delay(100);
+  ESP.restart();
+}
+
+void onNoPostDeadline() {
+  debug("Failsafe: no successful post for too long. Restarting...");
+  delay(100);
+  ESP.restart();
+}
+
+void onWiFiDownDeadline() {
+  debug("Failsafe: WiFi down too long. Restarting...");
+  delay(100);
+  ESP.restart();
+}
+
+// Config revalidation and manifest checks land at a per-board offset within their interval
+// (same hash as the send slot) instead of on the boot or fetch time the fleet shares.
+unsigned long msUntilFleetSlot(unsigned long now, unsigned long intervalMs) {
+  return msUntilSendSlot(now, intervalMs, sendSlotOffsetMs(String(DEVICE_ID).c_str(), intervalMs));
+}
+
+// --- Config fetch failure tracking helper ---
+// Retries shortly; the restart deadline only covers boards that never got a config.
+// A failed revalidation keeps the current config and waits for the next refresh.
+void markConfigFetchFailure() {
+  if (serverIp != "") {
+    return;
+  }
+
+  unsigned long now = millis();
+  scheduler.schedule(configFetchTask, now, withJitterMs(configFetchRetryInterval, configFetchJitterMs, ESP.random()));
+  if (serverIp == "" && !scheduler.isScheduled(configFailDeadline)) {
+    scheduler.schedule(configFailDeadline, now, maxConfigFetchFailBeforeRestartMs);
+  }
+}
+
+// --- Helper: percent-encode a query parameter value ---
+String urlEncode(const char* value) {
+  static const char hex[] = "0123456789ABCDEF";
+  String encoded;
+  for (const char* p = value; *p; p++) {
+    char c = *p;
+    if (isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.' || c == '~') {
+      encoded += c;
     } else {
-      http.end();
+      encoded += '%';
+      encoded += hex[(c >> 4) & 0x0F];
+      encoded += hex[c & 0x0F];
     }
   }
+  return encoded;
+}
 
-  return true;
+// --- Apply moisture calibration from a parsed config ---
+void applyMoistureCalibration(const DeviceConfig& config) {
+  #if MOISTURE_SENSOR_COUNT > 0
+  for (int i = 0; i < MOISTURE_SENSOR_COUNT; i++) {
+    moistureCalibrated[i] = false;
+    for (uint8_t c = 0; c < config.calibrationCount; c++) {
+      if (strcmp(config.calibrations[c].sensor, moistureSensors[i].name) == 0) {
+        moistureCurves[i] = config.calibrations[c].curve;
+        moistureCalibrated[i] = true;
+        break;
+      }
+    }
+    debug("Moisture " + String(moistureSensors[i].name) + " calibration: " + String(moistureCalibrated[i] ? "cached" : "none"));
+  }
+  #endif
+}
+
+// --- Apply intervals from a parsed config ---
+// Missing fields fall back to the firmware defaults, so removing an override reverts it.
+void applyDeviceIntervals(const DeviceConfig& config) {
+  DeviceIntervals next = config.intervals;
+  uint8_t clamped = boundDeviceIntervals(next, firmwareIntervals);
+  if (clamped > 0) {
+    debug(String(clamped) + " interval(s) from config out of bounds, clamped");
+  }
+
+  unsigned long now = millis();
+  bool changed = false;
+
+  // A slot assigned in the device config wins over the DEVICE_ID-derived one
+  unsigned long slot = config.sendSlotMs >= 0
+    ? static_cast<unsigned long>(config.sendSlotMs) % next.sendMs
+    : sendSlotOffsetMs(String(DEVICE_ID).c_str(), next.sendMs);
+  if (next.sendMs != sendInterval || slot != sendSlotMs) {
+    sendInterval = next.sendMs;
+    sendSlotMs = slot;
+    scheduler.setInterval(sensorCycleTask, sendInterval);
+    scheduler.schedule(sensorCycleTask, now, msUntilSendSlot(now, sendInterval, sendSlotMs));
+    changed = true;
+  }
+
+  if (next.connectivityCheckMs != connectivityCheckInterval) {
+    connectivityCheckInterval = next.connectivityCheckMs;
+    scheduler.setInterval(connectivityTask, connectivityCheckInterval);
+    scheduler.schedule(connectivityTask, now, connectivityCheckInterval);
+    changed = true;
+  }
+
+  if (next.probeMs != probeIntervalMs) {
+    probeIntervalMs = next.probeMs;
+    scheduler.setInterval(probeTask, probeIntervalMs);
+    scheduler.schedule(probeTask, now, probeIntervalMs);
+    changed = true;
+  }
+
+  if (next.configRefreshMs != configRefreshInterval) {
+    configRefreshInterval = next.configRefreshMs;
+    scheduler.setInterval(configRefreshTask, configRefreshInterval);
+    scheduler.schedule(configRefreshTask, now, msUntilFleetSlot(now, configRefreshInterval));
+    changed = true;
+  }
+
+  // Running deadlines restart from now with the new threshold
+  if (next.maxNoPostMs != maxNoPostBeforeRestartMs) {
+    maxNoPostBeforeRestartMs = next.maxNoPostMs;
+    if (scheduler.isScheduled(noPostDeadline)) {
+      scheduler.schedule(noPostDeadline, now, maxNoPostBeforeRestartMs);
+    }
+    changed = true;
+  }
+
+  if (next.maxWiFiDownMs != maxWiFiDownBeforeRestartMs || next.maxConfigFailMs != maxConfigFetchFailBeforeRestartMs) {
+    maxWiFiDownBeforeRestartMs = next.maxWiFiDownMs;
+    maxConfigFetchFailBeforeRestartMs = next.maxConfigFailMs;
+    changed = true;
+  }
+
+  if (changed) {
+    debug("Intervals: send " + String(sendInterval / 1000) + "s (slot " + String(sendSlotMs) + " ms)"
+      + ", check " + String(connectivityCheckInterval / 1000) + "s"
+      + ", probe " + String(probeIntervalMs / 1000) + "s"
+      + ", config " + String(configRefreshInterval / 1000) + "s"
+      + ", failsafes " + String(maxNoPostBeforeRestartMs / 1000) + "/" + String(maxWiFiDownBeforeRestartMs / 1000)
+      + "/" + String(maxConfigFetchFailBeforeRestartMs / 1000) + "s");
+  }
 }
 
 // --- Fetch Config ---
 void fetchServerConfig() {
   if (WiFi.status() != WL_CONNECTED) {
     debug("Not connected to WiFi, skipping config fetch");
-    configNeedsFetch = true;
     // Don't track failure time if WiFi is down - that's handled separately
     return;
   }
@@ -216,6 +632,17 @@ void fetchServerConfig() {
   HTTPClient http;
   WiFiClient client;
   String url = String(SERVER_URL) + CONFIG_PATH + "?deviceId=" + DEVICE_ID;
+
+  // Ask for calibration of our moisture sensors in the same request
+  #if MOISTURE_SENSOR_COUNT > 0
+  url += "&sensors=";
+  for (int i = 0; i < MOISTURE_SENSOR_COUNT; i++) {
+    if (i > 0) {
+      url += ",";
+    }
+    url += urlEncode(moistureSensors[i].name);
+  }
+  #endif
   debug("Fetching config from: " + url);
 
   http.setTimeout(5000);
@@ -224,10 +651,7 @@ void fetchServerConfig() {
   if (!http.begin(client, url)) {
     debug("Failed to begin HTTP connection");
     http.end();
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
-    }
+    markConfigFetchFailure();
     return;
   }
 
@@ -243,112 +667,274 @@ void fetchServerConfig() {
 
   if (code != 200) {
     debug("Config fetch failed with HTTP " + String(code));
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
-    }
+    markConfigFetchFailure();
     return;
   }
 
-  JsonDocument doc;
-  DeserializationError err = deserializeJson(doc, body);
-  if (err) {
-    debug("Failed to parse config: " + String(err.c_str()));
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
-    }
+  DeviceConfig parsed;
+  ConfigParseResult result = parseDeviceConfig(body.c_str(), body.length(), parsed);
+  if (result != ConfigParseResult::Ok) {
+    debug(configParseResultMessage(result));
+    markConfigFetchFailure();
     return;
   }
 
-  if (!doc["success"].as<bool>()) {
-    debug("Config fetch returned success: false");
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
+  if (serverIp != parsed.serverIp || serverPort != parsed.serverPort) {
+    configEndpointFailed = false;  // give a new endpoint a fresh chance
+  }
+  serverIp = parsed.serverIp;
+  serverPort = parsed.serverPort;
+  applyMoistureCalibration(parsed);
+  applyDeviceIntervals(parsed);
+
+  debug("Parsed server config: " + serverIp + ":" + String(serverPort));
+  scheduler.cancel(configFetchTask);
+  scheduler.cancel(configFailDeadline); // Clear failure tracking on success
+
+  // First manifest check once the server is known; later checks re-arm from the slot
+  unsigned long now = millis();
+  if (!scheduler.isScheduled(otaCheckTask)) {
+    scheduler.schedule(otaCheckTask, now, msUntilFleetSlot(now, otaCheckInterval));
+  }
+
+  if (!scheduler.isScheduled(configRefreshTask)) {
+    scheduler.schedule(configRefreshTask, now, msUntilFleetSlot(now, configRefreshInterval));
+  }
+}
+
+// --- Reading Sequence ---
+void loadReadingSequence() {
+  EEPROM.begin(sizeof(SequenceRecord));
+  SequenceRecord record;
+  EEPROM.get(0, record);
+  if (record.magic == sequenceRecordMagic && record.check == ~record.reservedThrough) {
+    nextReadingSeq = record.reservedThrough;
+  } else {
+    // Blank or wiped flash: start somewhere random rather than at 0, where this device's
+    // old readings would make the server drop new ones as duplicates
+    nextReadingSeq = ESP.random();
+    debug("No reading sequence in flash, starting at " + String(nextReadingSeq));
+  }
+  readingSeqReservedThrough = nextReadingSeq;  // first takeReadingSeq() reserves a block
+}
+
+uint32_t takeReadingSeq() {
+  if (static_cast<int32_t>(nextReadingSeq - readingSeqReservedThrough) >= 0) {
+    uint32_t reserve = nextReadingSeq + sequenceBlock;
+    SequenceRecord record = { sequenceRecordMagic, reserve, ~reserve };
+    EEPROM.put(0, record);
+    if (EEPROM.commit()) {
+      readingSeqReservedThrough = reserve;
+    } else {
+      // Retried on the next reading; a restart before then could reuse this seq
+      debug("Failed to persist reading sequence");
     }
-    return;
   }
+  return nextReadingSeq++;
+}
+
+// --- Post bookkeeping ---
+void markPostSuccess() {
+  lastSuccessfulPostMs = millis();
+  scheduler.schedule(noPostDeadline, lastSuccessfulPostMs, maxNoPostBeforeRestartMs);
+}
 
-  JsonArray dataArray = doc["value"]["data"];
-  if (dataArray.size() == 0) {
-    debug("No device config data found");
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
+// --- Backlog Storage ---
+// Written to a temp file and renamed over the old one, so a reset mid-write keeps the
+// previous copy. Ages exclude time spent powered off.
+void saveBacklog() {
+  if (!backlogStorageReady) {
+    return;
+  }
+  if (backlog.empty()) {
+    if (LittleFS.exists(backlogPath)) {
+      LittleFS.remove(backlogPath);
     }
     return;
   }
 
-  JsonObject deviceConfig = dataArray[0]["config"];
-  String defaultEnv = deviceConfig["defaultEnv"] | "prod";
-  JsonObject env = deviceConfig["environments"][defaultEnv];
+  File file = LittleFS.open(backlogTempPath, "w");
+  if (!file) {
+    debug("Failed to open backlog file for writing");
+    return;
+  }
+  bool ok = backlog.save(file, millis());
+  file.close();
+  if (!ok || !LittleFS.rename(backlogTempPath, backlogPath)) {
+    debug("Failed to save backlog (" + String(backlog.size()) + " readings)");
+    LittleFS.remove(backlogTempPath);
+  }
+}
 
-  serverIp = env["ip"].as<String>();
-  serverPort = env["port"].as<int>();
+void restoreBacklog() {
+  backlogStorageReady = LittleFS.begin();
+  if (!backlogStorageReady) {
+    debug("LittleFS mount failed; the backlog will not survive a restart");
+    return;
+  }
 
-  if (serverIp != "" && serverPort > 0) {
-    debug("Parsed server config: " + serverIp + ":" + String(serverPort));
-    configNeedsFetch = false;
-    firstConfigFetchFailureMs = 0; // Clear failure tracking on success
+  File file = LittleFS.open(backlogPath, "r");
+  if (!file) {
+    return;
+  }
+  if (backlog.restore(file, millis())) {
+    debug("Restored " + String(backlog.size()) + " backlog readings");
   } else {
-    debug("Config parsed but serverIp or serverPort is invalid");
-    configNeedsFetch = true;
-    if (firstConfigFetchFailureMs == 0) {
-      firstConfigFetchFailureMs = millis();
+    debug("Discarding unreadable backlog file");
+  }
+  file.close();
+}
+
+// --- Backlog Upload ---
+// Sends the oldest readings as compressed chunks until the backlog is empty, a chunk fails, or
+// maxChunksPerFlush chunks went out. Returns false if a chunk failed.
+bool flushBacklog() {
+  for (uint8_t sent = 0; sent < maxChunksPerFlush && !backlog.empty(); sent++) {
+    uint16_t covered = 0;
+    size_t len = backlog.encodeChunk(backlogChunk, sizeof(backlogChunk), backlogScratch, sizeof(backlogScratch),
+      millis(), maxReadingsPerChunk, covered);
+    if (len == 0) {
+      debug("Backlog chunk encode failed");
+      return false;
+    }
+
+    String response;
+    int status = serverRequest("POST", "api/sensor/bulk", "application/octet-stream", backlogChunk, len, 10000, &response);
+    if (status < 200 || status >= 300) {
+      debug("Backlog upload failed (" + serverErrorToString(status) + "), " + String(backlog.size()) + " readings kept");
+      return false;
     }
+
+    // The server answers with the next sequence it expects; everything before it is stored
+    uint32_t nextSeq = backlog.nextSeqAfter(covered);
+    StaticJsonDocument<192> ack;
+    if (!deserializeJson(ack, response)) {
+      nextSeq = ack["value"]["nextSeq"] | nextSeq;
+    }
+    backlog.ackThrough(nextSeq);
+    debug("Backlog chunk: " + String(covered) + " readings in " + String(len) + " bytes, " + String(backlog.size()) + " left");
+  }
+  return true;
+}
+
+// Re-arms the flush task: soon if the last flush only stopped at maxChunksPerFlush,
+// with jittered backoff if it failed, not at all once the backlog is empty.
+void scheduleBacklogFlush(bool failed) {
+  if (backlog.empty()) {
+    backlogRetryAttempt = 0;
+    scheduler.cancel(backlogFlushTask);
+    return;
+  }
+
+  unsigned long delayMs = 1000;
+  if (failed) {
+    if (backlogRetryAttempt < 255) {
+      backlogRetryAttempt++;
+    }
+    delayMs = backoffWithJitterMs(backlogRetryAttempt, backlogRetryBaseMs, backlogRetryCapMs, ESP.random());
+  } else {
+    backlogRetryAttempt = 0;
   }
+  scheduler.schedule(backlogFlushTask, millis(), delayMs);
+}
+
+// --- Scheduled: backlog flush (one-shot, re-armed until the backlog is empty) ---
+void runBacklogFlush() {
+  if (!wifiUp) {
+    scheduleBacklogFlush(true);
+    return;
+  }
+
+  bool ok = flushBacklog();
+  saveBacklog();
+  if (backlog.empty()) {
+    markPostSuccess();
+  }
+  scheduleBacklogFlush(!ok);
 }
 
 // --- POST Sensor Data ---
 // Returns true if ALL sensor posts succeeded in this cycle, false otherwise.
 // Includes max retries per sensor so the device cannot hang forever.
 bool postSensorData(float tempC, float humidity, int* moistureValues, int light) {
-  // Use the same domain as config fetch instead of IP from config
-  String url = String(SERVER_URL) + "api/sensor";
-  debug("POST target URL: " + url);
+  debug("POST target: " + String(serverUrl.host) + " via " + (serverIp != "" ? serverIp + ":" + String(serverPort) : String("DNS")));
 
   struct Sensor {
     const char* name;
     float value;
+    float calibrated;  // NaN when there is no calibration for this sensor
+    uint32_t seq;      // assigned below, once per reading
   };
 
   Sensor sensors[10];
   int idx = 0;
 
-  if (strlen(TEMP_SENSOR_NAME) > 0 && !isnan(tempC)) {
-    sensors[idx++] = { TEMP_SENSOR_NAME, tempC };
+  if (strlen(TEMP_SENSOR_NAME) > 0 && isValidReading(tempC)) {
+    sensors[idx++] = { TEMP_SENSOR_NAME, tempC, NAN, 0 };
   }
 
-  if (strlen(HUMIDITY_SENSOR_NAME) > 0 && !isnan(humidity)) {
-    sensors[idx++] = { HUMIDITY_SENSOR_NAME, humidity };
+  if (strlen(HUMIDITY_SENSOR_NAME) > 0 && isValidReading(humidity)) {
+    sensors[idx++] = { HUMIDITY_SENSOR_NAME, humidity, NAN, 0 };
   }
 
   #if MOISTURE_SENSOR_COUNT > 0
   for (int i = 0; i < MOISTURE_SENSOR_COUNT; i++) {
     if (strlen(moistureSensors[i].name) > 0) {
-      sensors[idx++] = { moistureSensors[i].name, static_cast<float>(moistureValues[i]) };
+      float calibrated = moistureCalibrated[i]
+        ? static_cast<float>(moistureQ8ToPercent(countsToMoistureQ8(moistureCurves[i], moistureValues[i])))
+        : NAN;
+      sensors[idx++] = { moistureSensors[i].name, moistureCountsToValue(moistureValues[i]), calibrated, 0 };
     }
   }
   #endif
 
   #if ENABLE_LUX_SENSOR
   if (strlen(LUX_SENSOR_NAME) > 0 && light >= 0) {
-    sensors[idx++] = { LUX_SENSOR_NAME, static_cast<float>(light) };
+    sensors[idx++] = { LUX_SENSOR_NAME, static_cast<float>(light), NAN, 0 };
   }
   #endif
 
+  // Keep the on-board cache current even if the upload fails. The seq stays with the reading
+  // through every retry and the backlog.
+  unsigned long readAtMs = millis();
+  for (int i = 0; i < idx; i++) {
+    sensors[i].seq = takeReadingSeq();
+    readingCache.record(sensors[i].name, readAtMs, sensors[i].value);
+  }
+
+  // Offline, or readings are already waiting: queue these behind them and replay everything
+  // in bulk (the flush waits for WiFi)
+  if (!wifiUp || !backlog.empty()) {
+    for (int i = 0; i < idx; i++) {
+      backlog.push(sensors[i].name, sensors[i].seq, readAtMs, sensors[i].value, sensors[i].calibrated);
+    }
+    if (!wifiUp) {
+      saveBacklog();
+      debug("WiFi down, " + String(backlog.size()) + " readings in backlog");
+      return false;
+    }
+    bool ok = flushBacklog();
+    saveBacklog();
+    scheduleBacklogFlush(!ok);
+    if (!backlog.empty()) {
+      return false;
+    }
+    markPostSuccess();
+    return true;
+  }
+
   bool allOk = true;
 
   for (int i = 0; i < idx; i++) {
-    // Use StaticJsonDocument; it's deprecated but still supported in this ArduinoJson version.
-    // The replacement JsonDocument type in v7 doesn't take a capacity in the constructor.
-    StaticJsonDocument<128> doc;
-    doc["sensor"] = sensors[i].name;
-    doc["value"] = sensors[i].value;
+    // Once one sensor gave up, the server is unlikely to take the rest; keep them for bulk
+    if (!allOk) {
+      backlog.push(sensors[i].name, sensors[i].seq, readAtMs, sensors[i].value, sensors[i].calibrated);
+      continue;
+    }
 
-    char payload[128];
-    size_t n = serializeJson(doc, payload, sizeof(payload));
+    char payload[160];
+    size_t n = buildReadingPayload(payload, sizeof(payload), sensors[i].name, sensors[i].value, sensors[i].calibrated,
+      DEVICE_ID, sensors[i].seq);
 
     debug("Sending payload: " + String(payload));
 
@@ -357,76 +943,192 @@ bool postSensorData(float tempC, float humidity, int* moistureValues, int light)
 
     for (int attempt = 1; attempt <= maxAttempts; attempt++) {
       // Try to keep WiFi alive, but do not block forever.
-      checkConnectivityNonBlocking();
+      maintainWiFiConnection();
 
       if (WiFi.status() != WL_CONNECTED) {
         debug("WiFi not connected before POST (attempt " + String(attempt) + ")");
-        delay(1000);
-        yield();
-        continue;
-      }
-
-      WiFiClient client;
-      HTTPClient http;
-      http.setTimeout(5000);
-      http.setReuse(false);
-
-      if (!http.begin(client, url)) {
-        debug("http.begin failed (attempt " + String(attempt) + ")");
-        http.end();
-        delay(750);
+        delay(backoffWithJitterMs(attempt, postRetryBaseMs, postRetryCapMs, ESP.random()));
         yield();
         continue;
       }
 
-      http.addHeader("Content-Type", "application/json");
-      http.addHeader("Connection", "close");
-      http.addHeader("Authorization", DEVICE_SECRET);
       debug("Sending Authorization header: " + String(DEVICE_SECRET) + " (POST to sensor endpoint)");
 
-      int status = http.POST(reinterpret_cast<const uint8_t*>(payload), n);
+      String response;
+      int status = serverRequest("POST", "api/sensor", "application/json",
+        reinterpret_cast<const uint8_t*>(payload), n, postTimeoutMs, &response);
 
-      if (status > 0 && status >= 200 && status < 300) {
-        String response = http.getString();
+      if (status >= 200 && status < 300) {
         debug("POST response code: " + String(status));
         debug("POST response body: " + response);
         success = true;
-        http.end();
         break;
       }
 
       if (status > 0) {
         debug("POST failed HTTP " + String(status) + " (attempt " + String(attempt) + ")");
       } else {
-        debug("POST transport error (attempt " + String(attempt) + "): " + http.errorToString(status));
+        debug("POST transport error (attempt " + String(attempt) + "): " + serverErrorToString(status));
       }
 
-      http.end();
-      delay(1500);
+      delay(backoffWithJitterMs(attempt, postRetryBaseMs, postRetryCapMs, ESP.random()));
       yield();
     }
 
     if (!success) {
-      debug("Giving up on sensor after max attempts: " + String(sensors[i].name));
+      debug("Giving up on sensor after max attempts: " + String(sensors[i].name) + " (kept for bulk upload)");
+      backlog.push(sensors[i].name, sensors[i].seq, readAtMs, sensors[i].value, sensors[i].calibrated);
       allOk = false;
-      // Continue to next sensor instead of hanging forever
     }
   }
 
   if (allOk) {
-    lastSuccessfulPostMs = millis();
+    markPostSuccess();
+  } else {
+    saveBacklog();
+    scheduleBacklogFlush(true);
   }
 
   return allOk;
 }
 
+// --- Firmware Update Check ---
+// Pulls ota/<channel>/manifest.json ({version, md5, size, file, allowDowngrade?}) and records
+// a pending update when it offers a newer version (or an older one with allowDowngrade).
+// The image itself is only downloaded in the maintenance window (see applyPendingUpdate).
+void checkForFirmwareUpdate() {
+  if (WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+
+  String baseUrl = String(OTA_BASE_URL) + OTA_CHANNEL + "/";
+  String url = baseUrl + "manifest.json";
+  debug("Checking firmware manifest: " + url);
+
+  HTTPClient http;
+  WiFiClient client;
+  http.setTimeout(5000);
+  http.setReuse(false);
+
+  if (!http.begin(client, url)) {
+    debug("Failed to begin manifest request");
+    http.end();
+    return;
+  }
+  // The app only serves manifests and images to boards
+  http.addHeader("Authorization", DEVICE_SECRET);
+
+  int code = http.GET();
+  String body = http.getString();
+  http.end();
+  yield();
+
+  if (code != 200) {
+    debug("Manifest fetch failed with HTTP " + String(code));
+    return;
+  }
+
+  JsonDocument doc;
+  DeserializationError err = deserializeJson(doc, body);
+  if (err) {
+    debug("Failed to parse manifest: " + String(err.c_str()));
+    return;
+  }
+
+  String version = doc["version"] | "";
+  String md5 = doc["md5"] | "";
+  size_t size = doc["size"] | 0UL;
+  String file = doc["file"] | "firmware.bin.gz";
+  bool allowDowngrade = doc["allowDowngrade"] | false;
+
+  if (version == "" || md5.length() != 32 || size == 0) {
+    debug("Manifest is missing version, md5 or size");
+    return;
+  }
+
+  if (!shouldInstallFirmware(FIRMWARE_VERSION, version.c_str(), allowDowngrade)) {
+    debug("Not installing manifest version " + version + " over " + String(FIRMWARE_VERSION)
+      + (allowDowngrade ? "" : " (downgrades need allowDowngrade)"));
+    pendingUpdate.available = false;
+    return;
+  }
+
+  if (size > ESP.getFreeSketchSpace()) {
+    debug("Firmware " + version + " (" + String(size) + " bytes) does not fit in free sketch space");
+    return;
+  }
+
+  pendingUpdate = { true, version, md5, size, baseUrl + file };
+  debug("Firmware update pending: " + String(FIRMWARE_VERSION) + " -> " + version);
+}
+
+// --- Apply Firmware Update ---
+// Called right after a sensor cycle so the reboot never costs a reading.
+// The gzip image is streamed straight into flash; the Updater checks the MD5 and eboot
+// decompresses it on the next boot.
+void applyPendingUpdate() {
+  if (!pendingUpdate.available || WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+
+  debug("Downloading firmware " + pendingUpdate.version + " from " + pendingUpdate.url);
+
+  HTTPClient http;
+  WiFiClient client;
+  http.setTimeout(10000);
+  http.setReuse(false);
+
+  if (!http.begin(client, pendingUpdate.url)) {
+    debug("Failed to begin firmware download");
+    http.end();
+    return;
+  }
+  http.addHeader("Authorization", DEVICE_SECRET);
+
+  int code = http.GET();
+  if (code != 200) {
+    debug("Firmware download failed with HTTP " + String(code));
+    http.end();
+    return;
+  }
+
+  int len = http.getSize();
+  if (len != static_cast<int>(pendingUpdate.size)) {
+    debug("Firmware size mismatch: manifest " + String(pendingUpdate.size) + ", server " + String(len));
+    http.end();
+    // Manifest and image are out of sync; wait for the next manifest check
+    pendingUpdate.available = false;
+    return;
+  }
+
+  if (!Update.begin(pendingUpdate.size)) {
+    debug("Update.begin failed: " + Update.getErrorString());
+    http.end();
+    return;
+  }
+  Update.setMD5(pendingUpdate.md5.c_str());
+
+  size_t written = Update.writeStream(*http.getStreamPtr());
+  http.end();
+
+  if (written != pendingUpdate.size || !Update.end()) {
+    debug("Firmware update failed after " + String(written) + " bytes: " + Update.getErrorString());
+    pendingUpdate.available = false;
+    return;
+  }
+
+  debug("Firmware " + pendingUpdate.version + " written and verified. Restarting...");
+  delay(100);
+  ESP.restart();
+}
+
 // --- Sensor Cycle ---
 void runSensorCycle() {
   debug("Send interval reached");
 
-  if (WiFi.status() != WL_CONNECTED) {
-    debug("WiFi not connected, skipping sensor cycle");
-    return;
+  // Never skip a reading: while WiFi is down it goes to the backlog
+  if (!wifiUp) {
+    debug("WiFi not connected, queueing this cycle's readings");
   }
 
   float tempC = NAN;
@@ -439,7 +1141,7 @@ void runSensorCycle() {
     hum = dht.readHumidity();
     yield();
 
-    if (isnan(tempC) || isnan(hum)) {
+    if (!isValidReading(tempC) || !isValidReading(hum)) {
       debug("DHT22 read failed. Temp: " + String(tempC) + ", Humidity: " + String(hum));
     } else {
       debug("DHT22 values: Temp = " + String(tempC) + " C, Humidity = " + String(hum) + " %");
@@ -474,8 +1176,8 @@ void runSensorCycle() {
   tsl.getEvent(&event);
   yield();
 
-  if (event.light) {
-    light = static_cast<int>(event.light);
+  light = luxToReading(event.light);
+  if (light >= 0) {
     debug("TSL2561 lux: " + String(light));
   } else {
     debug("TSL2561 read failed or sensor saturated");
@@ -488,10 +1190,92 @@ void runSensorCycle() {
   } else {
     debug("Sensor data post had failures");
   }
+
+  // Maintenance window: the next reading is a full send interval away
+  applyPendingUpdate();
+}
+
+// --- Status Report (/status and /) ---
+void sendStatusReport(bool asJson) {
+  unsigned long now = millis();
+  String ip = WiFi.localIP().toString();
+  String resetReason = ESP.getResetReason();
+
+  StatusSnapshot snapshot;
+  snapshot.wifiConnected = WiFi.status() == WL_CONNECTED;
+  snapshot.ip = ip.c_str();
+  snapshot.rssi = WiFi.RSSI();
+  snapshot.uptimeSec = now / 1000;
+  snapshot.deviceId = DEVICE_ID;
+  snapshot.firmwareVersion = FIRMWARE_VERSION;
+  snapshot.serverIp = serverIp.c_str();
+  snapshot.serverPort = serverPort;
+  snapshot.freeHeap = ESP.getFreeHeap();
+  snapshot.resetReason = resetReason.c_str();
+  snapshot.lastPostAgeSec = (lastSuccessfulPostMs == 0) ? 0 : (now - lastSuccessfulPostMs) / 1000;
+  snapshot.lastWiFiChangeSec = (now - lastWiFiTransitionMs) / 1000;
+
+  char body[512];
+  if (asJson) {
+    formatStatusJson(body, sizeof(body), snapshot);
+    server.send(200, "application/json", body);
+  } else {
+    formatStatusText(body, sizeof(body), snapshot);
+    server.send(200, "text/plain", body);
+  }
+}
+
+// --- Recent Readings (/readings?since=<seq>) ---
+// Streams the RAM cache as compact CSV. The ETag changes whenever a reading is recorded,
+// so pollers get a bodyless 304 until there is something new.
+void sendRecentReadings() {
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%08lx-%lu\"",
+    static_cast<unsigned long>(readingCache.bootId()),
+    static_cast<unsigned long>(readingCache.latestSeq()));
+
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+
+  if (server.header("If-None-Match") == etag) {
+    server.send(304, "text/csv", "");
+    return;
+  }
+
+  uint32_t since = 0;
+  if (server.hasArg("since")) {
+    since = strtoul(server.arg("since").c_str(), nullptr, 10);
+  }
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/csv", "");
+
+  char page[256];
+  ReadingCacheCursor cursor;
+  unsigned long now = millis();
+  size_t n;
+  while ((n = readingCache.formatReadings(page, sizeof(page), since, now, cursor)) > 0) {
+    server.sendContent(page, n);
+    yield();
+  }
+  // Zero-length chunk terminates the chunked response
+  server.sendContent("");
 }
 
 void setup() {
   Serial.begin(115200);
+  readingCache.setBootId(ESP.random());
+  backlog.setBootId(readingCache.bootId());
+  backlog.setDeviceId(DEVICE_ID);
+  restoreBacklog();
+  loadReadingSequence();
+  debug("Firmware version: " + String(FIRMWARE_VERSION) + " (channel " + String(OTA_CHANNEL) + ")");
+
+  serverUrlValid = parseHttpUrl(SERVER_URL, serverUrl);
+  if (!serverUrlValid) {
+    debug("SERVER_URL must be http://host[:port]/path; uploads are disabled");
+  }
 
   if (strlen(TEMP_SENSOR_NAME) > 0 || strlen(HUMIDITY_SENSOR_NAME) > 0) {
     dht.begin();
@@ -563,7 +1347,11 @@ void setup() {
   
   // Configure WiFi settings
   WiFi.mode(WIFI_STA);
+#if ENABLE_MODEM_SLEEP
+  WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+#else
   WiFi.setSleepMode(WIFI_NONE_SLEEP);
+#endif
   WiFi.setOutputPower(20.5);
   WiFi.hostname("nodemcu-sensor");
   // Don't force 11N mode - let it auto-negotiate for better compatibility
@@ -679,11 +1467,38 @@ void setup() {
     debug("Will retry in connectivity check");
   }
 
+  // --- Scheduler Setup ---
+  sensorCycleTask = scheduler.add("sensor-cycle", runSensorCycle, sendInterval);
+  connectivityTask = scheduler.add("connectivity", runConnectivityCheck, connectivityCheckInterval);
+  probeTask = scheduler.add("probe", runConnectivityProbe, probeIntervalMs);
+  configFetchTask = scheduler.add("config-fetch", runConfigFetch, 0);
+  configRefreshTask = scheduler.add("config-refresh", runConfigRefresh, configRefreshInterval);
+  otaCheckTask = scheduler.add("ota-check", checkForFirmwareUpdate, otaCheckInterval);
+  backlogFlushTask = scheduler.add("backlog-flush", runBacklogFlush, 0);
+  noPostDeadline = scheduler.add("no-post-failsafe", onNoPostDeadline, 0);
+  wifiDownDeadline = scheduler.add("wifi-down-failsafe", onWiFiDownDeadline, 0);
+  configFailDeadline = scheduler.add("config-fail-failsafe", onConfigFailDeadline, 0);
+
   // Initialize tracking baselines
-  lastWiFiStatus = WiFi.status();
-  lastWiFiTransitionMs = millis();
-  if (lastWiFiStatus == WL_CONNECTED) {
-    lastReconnectTimeMs = millis();
+  unsigned long now = millis();
+  wifiEventPending = false;
+  wifiUp = WiFi.status() == WL_CONNECTED;
+  lastWiFiTransitionMs = now;
+  if (wifiUp) {
+    lastReconnectTimeMs = now;
+  } else {
+    scheduler.schedule(wifiDownDeadline, now, maxWiFiDownBeforeRestartMs);
+  }
+
+  sendSlotMs = sendSlotOffsetMs(String(DEVICE_ID).c_str(), sendInterval);
+  debug("Send slot: " + String(sendSlotMs) + " ms into each " + String(sendInterval / 1000) + " s interval");
+  // Later cycles re-arm from this due time, so they stay on slot + k * sendInterval
+  scheduler.schedule(sensorCycleTask, now, msUntilSendSlot(now, sendInterval, sendSlotMs));
+  scheduler.schedule(connectivityTask, now, connectivityCheckInterval);
+  scheduler.schedule(probeTask, now, probeIntervalMs);
+  if (!backlog.empty()) {
+    // Readings restored from flash; give the config fetch a head start
+    scheduler.schedule(backlogFlushTask, now, withJitterMs(backlogRetryBaseMs, reconnectJitterMs, ESP.random()));
   }
 
   // Health check endpoint
@@ -696,41 +1511,14 @@ void setup() {
   });
 
   // Status endpoint with more detailed info
-  server.on("/status", HTTP_GET, []() {
-    unsigned long now = millis();
-    unsigned long lastPostAgeSec = (lastSuccessfulPostMs == 0) ? 0 : (now - lastSuccessfulPostMs) / 1000;
-    unsigned long lastWiFiChangeSec = (now - lastWiFiTransitionMs) / 1000;
-
-    String response = "{";
-    response += "\"status\":\"" + String(WiFi.status() == WL_CONNECTED ? "healthy" : "unhealthy") + "\",";
-    response += "\"wifi\":\"" + String(WiFi.status() == WL_CONNECTED ? "connected" : "disconnected") + "\",";
-    response += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
-    response += "\"rssi\":" + String(WiFi.RSSI()) + ",";
-    response += "\"uptime\":" + String(now / 1000) + ",";
-    response += "\"device_id\":\"" + String(DEVICE_ID) + "\",";
-    response += "\"server_ip\":\"" + serverIp + "\",";
-    response += "\"server_port\":" + String(serverPort) + ",";
-    response += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
-    response += "\"reset_reason\":\"" + String(ESP.getResetReason()) + "\",";
-    response += "\"last_post_age_sec\":" + String(lastPostAgeSec) + ",";
-    response += "\"last_wifi_change_age_sec\":" + String(lastWiFiChangeSec);
-    response += "}";
-
-    server.send(200, "application/json", response);
-  });
+  server.on("/status", HTTP_GET, []() { sendStatusReport(true); });
 
-  server.on("/", HTTP_GET, []() {
-    String info = "ESP8266 Sensor Node\n";
-    info += "Device ID: " + String(DEVICE_ID) + "\n";
-    info += "IP: " + WiFi.localIP().toString() + "\n";
-    info += "WiFi: " + String(WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected") + "\n";
-    info += "RSSI: " + String(WiFi.RSSI()) + " dBm\n";
-    info += "Uptime: " + String(millis() / 1000) + " seconds\n";
-    info += "FreeHeap: " + String(ESP.getFreeHeap()) + "\n";
-    info += "ResetReason: " + String(ESP.getResetReason()) + "\n";
-    info += "Server: " + (serverIp == "" ? String("<unset>") : serverIp + ":" + String(serverPort));
-    server.send(200, "text/plain", info);
-  });
+  server.on("/", HTTP_GET, []() { sendStatusReport(false); });
+
+  server.on("/readings", HTTP_GET, sendRecentReadings);
+
+  const char* collectedHeaders[] = { "If-None-Match" };
+  server.collectHeaders(collectedHeaders, 1);
 
   server.onNotFound([]() {
     server.send(404, "text/plain", "Not Found");
@@ -740,10 +1528,17 @@ void setup() {
   debug("Web server started on port 80");
   debug("Health endpoint: http://" + WiFi.localIP().toString() + "/health");
 
-  fetchServerConfig();
+  if (wifiUp) {
+    // Jittered so boards powered up together don't all hit the config endpoint at once
+    scheduler.schedule(configFetchTask, now, withJitterMs(0, configFetchJitterMs, ESP.random()));
+  } else {
+    // Config fetch is armed by handleWiFiTransition() once WiFi comes up
+    debug("Skipping initial config fetch until WiFi is up");
+  }
 
   // --- OTA Setup ---
-  ArduinoOTA.setHostname("nodemcu");
+  // Local push OTA stays available for bench flashing; fleet updates use the pull updater
+  ArduinoOTA.setHostname(String(DEVICE_ID).c_str());
   ArduinoOTA.onStart([]() { debug("OTA Update Start"); });
   ArduinoOTA.onEnd([]() { debug("OTA Update Complete"); });
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
@@ -759,71 +1554,15 @@ void setup() {
 void loop() {
   ArduinoOTA.handle();
   server.handleClient();
-  yield();
-
-  // Always try to keep WiFi connected (non-blocking)
-  bool wifiOk = checkConnectivityNonBlocking();
-
-  // Check if WiFi just got an IP address (fallback if onWiFiGotIP didn't fire)
-  if (WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0)) {
-    // WiFi is connected and has an IP, ensure config fetch is triggered
-    if (serverIp == "" && !configNeedsFetch) {
-      debug("WiFi has IP but config not fetched, triggering config fetch");
-      configNeedsFetch = true;
-      firstConfigFetchFailureMs = 0; // Clear failure tracking
-    }
-  }
-
-  // Fetch config if needed (rate-limited)
-  if (configNeedsFetch && WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0)) {
-    unsigned long now = millis();
-    if (now - lastConfigFetchAttempt >= configFetchRetryInterval) {
-      lastConfigFetchAttempt = now;
-      // Initialize failure tracking if this is the first attempt and serverIp is empty
-      if (serverIp == "" && firstConfigFetchFailureMs == 0) {
-        firstConfigFetchFailureMs = now;
-      }
-      fetchServerConfig();
-      yield();
-    }
-  }
-
-  // Failsafe restart if config fetch has been failing for too long
-  if (serverIp == "" && configNeedsFetch && WiFi.status() == WL_CONNECTED && firstConfigFetchFailureMs != 0) {
-    unsigned long sinceFirstFailure = millis() - firstConfigFetchFailureMs;
-    if (sinceFirstFailure > maxConfigFetchFailBeforeRestartMs) {
-      debug("Failsafe: config fetch failing for too long (" + String(sinceFirstFailure / 1000) + "s). Restarting...");
-      delay(100);
-      ESP.restart();
-    }
-  }
 
-  // Failsafe restart if we've gone too long without a successful post
-  if (lastSuccessfulPostMs != 0) {
-    unsigned long sinceLastPost = millis() - lastSuccessfulPostMs;
-    if (sinceLastPost > maxNoPostBeforeRestartMs) {
-      debug("Failsafe: no successful post for too long. Restarting...");
-      delay(100);
-      ESP.restart();
-    }
-  }
+  handleWiFiTransition();
+  scheduler.runDue(millis());
 
-  // Failsafe restart if WiFi has been down for an extended period
-  if (WiFi.status() != WL_CONNECTED) {
-    unsigned long sinceLastWiFiChange = millis() - lastWiFiTransitionMs;
-    if (sinceLastWiFiChange > maxWiFiDownBeforeRestartMs) {
-      debug("Failsafe: WiFi down too long. Restarting...");
-      delay(100);
-      ESP.restart();
-    }
-  }
-
-  // Run sensor cycle on interval if WiFi is connected (do not gate on probe)
-  if (wifiOk && WiFi.status() == WL_CONNECTED) {
-    unsigned long now = millis();
-    if (now - lastSent >= sendInterval) {
-      lastSent = now;
-      runSensorCycle();
-    }
+  // Idle until the next task is due; delay() yields to the SDK so the radio can modem-sleep
+  unsigned long waitMs = scheduler.msUntilNext(millis(), maxIdleWaitMs);
+  if (waitMs > 0) {
+    delay(waitMs);
+  } else {
+    yield();
   }
 }
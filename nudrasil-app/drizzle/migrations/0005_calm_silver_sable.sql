@@ -0,0 +1 @@
+ALTER TABLE "sensor_readings" ADD COLUMN "calibrated_value" double precision;
\ No newline at end of file
@@ -0,0 +1,3 @@
+ALTER TABLE "sensor_readings" ADD COLUMN "device_id" text;--> statement-breakpoint
+ALTER TABLE "sensor_readings" ADD COLUMN "seq" bigint;--> statement-breakpoint
+CREATE UNIQUE INDEX "idx_sensor_readings_device_seq" ON "sensor_readings" USING btree ("device_id","seq");
\ No newline at end of file
@@ -6,8 +6,10 @@ import {
   timestamp,
   doublePrecision,
   integer,
+  bigint,
   jsonb,
   index,
+  uniqueIndex,
   inet,
 } from "drizzle-orm/pg-core";
 
@@ -70,6 +72,12 @@ export const sensorReadings = pgTable(
       .notNull()
       .references(() => sensors.id, { onDelete: "cascade" }),
     value: doublePrecision("value").notNull(),
+    // Moisture % converted on the board from its cached calibration (null for other sensors)
+    calibratedValue: doublePrecision("calibrated_value"),
+    // Sending board and its per-device reading sequence. A retried upload hits
+    // the unique index below instead of adding a row (null for older readings)
+    deviceId: text("device_id"),
+    seq: bigint("seq", { mode: "number" }),
     readingTime: timestamp("reading_time", {
       mode: "string",
       withTimezone: true,
@@ -82,6 +90,10 @@ export const sensorReadings = pgTable(
   (table) => {
     return {
       readingTimeIndex: index("idx_sensor_readings_time").on(table.readingTime),
+      deviceSeqIndex: uniqueIndex("idx_sensor_readings_device_seq").on(
+        table.deviceId,
+        table.seq,
+      ),
     };
   },
 );
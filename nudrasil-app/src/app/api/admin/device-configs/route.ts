@@ -1,14 +1,15 @@
 // app/api/admin/device-configs/route.ts
 import { NextRequest } from "next/server";
-import { eq } from "drizzle-orm";
+import { eq, inArray } from "drizzle-orm";
 import { db } from "@/lib/db";
-import { device_configs } from "@root/drizzle/schema";
+import { device_configs, sensors } from "@root/drizzle/schema";
 import { requirePlantAdminRole } from "@/utils/requirePlantAdminRole";
 import {
   createApiResponse,
   createUnauthorizedResponse,
 } from "@/utils/apiResponse";
 import { getToken } from "next-auth/jwt";
+import { hasValidDeviceSecret } from "@/utils/deviceAuth";
 
 // Simple IP address pattern - matches IPv4 addresses (e.g., 192.168.1.1)
 const IP_REGEX = /\b\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}\b/g;
@@ -46,19 +47,127 @@ function maskIpsInObject(obj: unknown): unknown {
   return obj;
 }
 
+interface SensorCalibration {
+  sensor: string;
+  min: number;
+  max: number;
+  points?: [number, number][];
+}
+
+// Limits boards enforce in buildCalibrationCurve() (lib/nudrasil_core/src/sensor_math.h)
+const MAX_CURVE_POINTS = 6;
+const MAX_SENSOR_COUNTS = 32767;
+
+function isValidCounts(value: unknown): value is number {
+  return (
+    typeof value === "number" &&
+    Number.isFinite(value) &&
+    value >= 0 &&
+    value <= MAX_SENSOR_COUNTS
+  );
+}
+
 /**
- * Checks if the request has a valid device secret in the Authorization header
+ * Checks a moisture curve: 2..6 [counts, percent] points, counts 0..32767 and strictly
+ * increasing, percent 0..100
  */
-function hasValidDeviceSecret(req: NextRequest): boolean {
-  const authHeader = req.headers.get("authorization");
-  if (!authHeader) {
+function isValidMoistureCurve(points: unknown): points is [number, number][] {
+  if (
+    !Array.isArray(points) ||
+    points.length < 2 ||
+    points.length > MAX_CURVE_POINTS
+  ) {
     return false;
   }
+  return points.every((point, i) => {
+    if (!Array.isArray(point) || point.length !== 2) {
+      return false;
+    }
+    const [counts, percent] = point;
+    return (
+      isValidCounts(counts) &&
+      typeof percent === "number" &&
+      percent >= 0 &&
+      percent <= 100 &&
+      (i === 0 || counts > points[i - 1][0])
+    );
+  });
+}
+
+/**
+ * Name of the first sensor in `config.moistureCurves` whose curve is invalid, if any
+ */
+function findInvalidMoistureCurve(config: unknown): string | null {
+  const curves = (config as { moistureCurves?: unknown } | null)
+    ?.moistureCurves;
+  if (curves === undefined) {
+    return null;
+  }
+  if (typeof curves !== "object" || curves === null || Array.isArray(curves)) {
+    return "moistureCurves";
+  }
+  const invalid = Object.entries(curves).find(
+    ([, points]) => !isValidMoistureCurve(points),
+  );
+  return invalid ? invalid[0] : null;
+}
 
-  // Check if the Authorization header matches the device secret
-  // The firmware sends: Authorization: {secret}
-  const deviceSecret = process.env.ADMIN_SECRET;
-  return authHeader === deviceSecret;
+function invalidMoistureCurveResponse(sensor: string) {
+  return createApiResponse(
+    {
+      success: false,
+      message: `Invalid moisture curve for ${sensor}: use 2-${MAX_CURVE_POINTS} [counts, percent] points with counts 0-${MAX_SENSOR_COUNTS} strictly increasing and percent 0-100`,
+    },
+    { status: 400 },
+  );
+}
+
+/**
+ * Looks up moisture calibration for the named sensors so a board can cache it with its config
+ * Optional `moistureCurves: { [sensor]: [[counts, percent], ...] }` in the device config overrides
+ * the two-point min/max curve; invalid curves fall back to it
+ */
+async function getSensorCalibration(
+  sensorNames: string[],
+  config: unknown,
+): Promise<SensorCalibration[]> {
+  if (sensorNames.length === 0) {
+    return [];
+  }
+
+  const rows = await db
+    .select({
+      name: sensors.name,
+      min: sensors.minCalibratedValue,
+      max: sensors.maxCalibratedValue,
+    })
+    .from(sensors)
+    .where(inArray(sensors.name, sensorNames));
+
+  const curves =
+    (config as { moistureCurves?: Record<string, unknown> } | null)
+      ?.moistureCurves ?? {};
+
+  // Boards reject invalid calibration, so leave it out rather than send it
+  return rows
+    .filter(
+      (row) =>
+        isValidCounts(row.min) && isValidCounts(row.max) && row.min < row.max,
+    )
+    .map((row) => {
+      const points = curves[row.name];
+      if (points !== undefined && !isValidMoistureCurve(points)) {
+        console.warn(
+          `Ignoring invalid moistureCurves entry for sensor ${row.name}`,
+        );
+      }
+      return {
+        sensor: row.name,
+        min: row.min!,
+        max: row.max!,
+        ...(isValidMoistureCurve(points) ? { points } : {}),
+      };
+    });
 }
 
 /**
@@ -94,6 +203,11 @@ export async function GET(req: NextRequest) {
   try {
     const url = new URL(req.url);
     const deviceId = url.searchParams.get("deviceId");
+    // Boards pass their moisture sensor names to receive calibration with the config
+    const sensorNames = (url.searchParams.get("sensors") ?? "")
+      .split(",")
+      .map((name) => name.trim())
+      .filter((name) => name.length > 0);
     const isAuthenticated = await hasPlantAdminRole(req);
 
     let configs;
@@ -114,6 +228,14 @@ export async function GET(req: NextRequest) {
       }));
     }
 
+    if (deviceId && sensorNames.length > 0) {
+      const calibration = await getSensorCalibration(
+        sensorNames,
+        configs[0]?.config ?? null,
+      );
+      return createApiResponse({ data: configs, calibration });
+    }
+
     return createApiResponse({ data: configs });
   } catch (error) {
     console.error("Error fetching device configs:", error);
@@ -147,6 +269,11 @@ export async function POST(req: NextRequest) {
       );
     }
 
+    const invalidCurve = findInvalidMoistureCurve(config);
+    if (invalidCurve) {
+      return invalidMoistureCurveResponse(invalidCurve);
+    }
+
     await db.insert(device_configs).values({
       device_id: deviceId,
       config,
@@ -185,6 +312,11 @@ export async function PATCH(req: NextRequest) {
       );
     }
 
+    const invalidCurve = findInvalidMoistureCurve(config);
+    if (invalidCurve) {
+      return invalidMoistureCurveResponse(invalidCurve);
+    }
+
     await db
       .update(device_configs)
       .set({ config })
@@ -0,0 +1,90 @@
+import { NextRequest } from "next/server";
+import { db } from "@/lib/db";
+import { sensors, sensorReadings } from "@root/drizzle/schema";
+import { inArray } from "drizzle-orm";
+import { createApiError, createApiResponse } from "@/utils/apiResponse";
+import { BacklogDecodeError, decodeBacklogChunk } from "@/utils/backlogCodec";
+import { updateBoardIp } from "@/utils/boardIp";
+
+/**
+ * Bulk upload of readings a board buffered while it could not post them one by one
+ * Body is one binary backlog chunk (see utils/backlogCodec.ts). The response's nextSeq
+ * acknowledges the chunk; the board resends anything it has not seen acknowledged, and
+ * readings stored by an earlier attempt are skipped by the (device, seq) unique index.
+ */
+export async function POST(req: NextRequest) {
+  try {
+    const receivedAt = Date.now();
+    const chunk = decodeBacklogChunk(new Uint8Array(await req.arrayBuffer()));
+
+    const names = chunk.blocks.map((block) => block.sensor);
+    const sensorRows =
+      names.length > 0
+        ? await db
+            .select({
+              id: sensors.id,
+              name: sensors.name,
+              boardId: sensors.boardId,
+            })
+            .from(sensors)
+            .where(inArray(sensors.name, names))
+        : [];
+    const sensorsByName = new Map(sensorRows.map((s) => [s.name, s]));
+
+    const rows: (typeof sensorReadings.$inferInsert)[] = [];
+    let skipped = 0;
+    // Sequences are uint32 and may wrap, so compare by distance from firstSeq
+    let lastOffset = 0;
+    for (const block of chunk.blocks) {
+      for (const reading of block.readings) {
+        lastOffset = Math.max(lastOffset, (reading.seq - chunk.firstSeq) >>> 0);
+      }
+      const sensor = sensorsByName.get(block.sensor);
+      if (!sensor) {
+        // Still acknowledged so the board doesn't retry readings we can never store
+        console.error("Sensor not found:", block.sensor);
+        skipped += block.readings.length;
+        continue;
+      }
+      for (const reading of block.readings) {
+        rows.push({
+          sensorId: sensor.id,
+          value: reading.value,
+          calibratedValue: reading.calibrated,
+          deviceId: chunk.deviceId || null,
+          seq: reading.seq,
+          readingTime: new Date(receivedAt - reading.ageMs).toISOString(),
+        });
+      }
+    }
+
+    const nextSeq = (chunk.firstSeq + lastOffset + 1) >>> 0;
+
+    const inserted =
+      rows.length > 0
+        ? await db
+            .insert(sensorReadings)
+            .values(rows)
+            .onConflictDoNothing()
+            .returning({ id: sensorReadings.id })
+        : [];
+
+    const boardId = sensorRows.find((s) => s.boardId)?.boardId;
+    if (boardId) {
+      await updateBoardIp(req, boardId);
+    }
+
+    return createApiResponse({
+      nextSeq,
+      stored: inserted.length,
+      duplicates: rows.length - inserted.length,
+      skipped,
+    });
+  } catch (err) {
+    if (err instanceof BacklogDecodeError) {
+      return createApiError(err.message, 400);
+    }
+    console.error("Error handling ESP bulk upload:", err);
+    return createApiError("Failed to store backlog", 500);
+  }
+}
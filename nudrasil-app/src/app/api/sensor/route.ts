@@ -1,13 +1,23 @@
 import { NextRequest, NextResponse } from "next/server";
 import { db } from "@/lib/db";
-import { sensors, sensorReadings, boards } from "@root/drizzle/schema";
-import { eq, desc, and, not } from "drizzle-orm";
+import { sensors, sensorReadings } from "@root/drizzle/schema";
+import { eq, desc } from "drizzle-orm";
+import { updateBoardIp } from "@/utils/boardIp";
 
 export async function POST(req: NextRequest): Promise<NextResponse> {
   try {
     const body = await req.json();
 
-    if (typeof body.sensor !== "string" || typeof body.value !== "number") {
+    if (
+      typeof body.sensor !== "string" ||
+      typeof body.value !== "number" ||
+      (body.calibrated !== undefined && typeof body.calibrated !== "number") ||
+      (body.device !== undefined && typeof body.device !== "string") ||
+      (body.seq !== undefined &&
+        (!Number.isInteger(body.seq) ||
+          body.seq < 0 ||
+          body.device === undefined))
+    ) {
       return NextResponse.json(
         { success: false, error: "Invalid input" },
         { status: 400 },
@@ -15,8 +25,6 @@ export async function POST(req: NextRequest): Promise<NextResponse> {
     }
 
     const readingTime = new Date().toISOString(); // Ensure UTC ISO string
-    const ip =
-      req.headers.get("x-forwarded-for")?.split(",")[0]?.trim() ?? "0.0.0.0";
 
     // Find sensor by name
     const sensorResult = await db
@@ -36,28 +44,28 @@ export async function POST(req: NextRequest): Promise<NextResponse> {
     const sensorId = sensorResult[0].id;
     const boardId = sensorResult[0].boardId;
 
-    // Insert new reading
-    await db.insert(sensorReadings).values({
-      sensorId: sensorId,
-      value: body.value,
-      readingTime: readingTime, // Store as ISO string
-    });
+    // Insert new reading; a retry of a stored (device, seq) is a no-op
+    const inserted = await db
+      .insert(sensorReadings)
+      .values({
+        sensorId: sensorId,
+        value: body.value,
+        calibratedValue: body.calibrated ?? null,
+        deviceId: body.device ?? null,
+        seq: body.seq ?? null,
+        readingTime: readingTime, // Store as ISO string
+      })
+      .onConflictDoNothing()
+      .returning({ id: sensorReadings.id });
 
     if (boardId) {
-      // Clear the IP from any other board that has it
-      await db
-        .update(boards)
-        .set({ lastKnownIp: null })
-        .where(and(eq(boards.lastKnownIp, ip), not(eq(boards.id, boardId))));
-
-      // Set the IP on the current board
-      await db
-        .update(boards)
-        .set({ lastKnownIp: ip })
-        .where(eq(boards.id, boardId));
+      await updateBoardIp(req, boardId);
     }
 
-    return NextResponse.json({ success: true });
+    return NextResponse.json({
+      success: true,
+      duplicate: inserted.length === 0,
+    });
   } catch (err) {
     console.error("Error handling ESP sensor POST:", err);
     return NextResponse.json(
@@ -85,6 +93,7 @@ export async function GET(req: NextRequest): Promise<NextResponse> {
         id: sensorReadings.id,
         sensorId: sensorReadings.sensorId,
         value: sensorReadings.value,
+        calibratedValue: sensorReadings.calibratedValue,
         readingTime: sensorReadings.readingTime,
       })
       .from(sensorReadings)
@@ -0,0 +1,48 @@
+// Serves OTA images written by firmware/esp-dht22-sensor/scripts/ota_publish.py
+// Copy ota/<env>/ into FIRMWARE_DIR/<env>/ on the app host
+// Images are built with the board's WiFi credentials and device secret, so only boards
+// (Authorization: DEVICE_SECRET) may download them
+
+import { readFile } from "node:fs/promises";
+import path from "node:path";
+import { hasValidDeviceSecret } from "@/utils/deviceAuth";
+
+const FIRMWARE_DIR =
+  process.env.FIRMWARE_DIR ?? path.join(process.cwd(), "firmware");
+
+const FILES: Record<string, string> = {
+  "manifest.json": "application/json",
+  "firmware.bin.gz": "application/octet-stream",
+};
+
+const CHANNEL_PATTERN = /^[A-Za-z0-9_-]+$/;
+
+export async function GET(
+  req: Request,
+  { params }: { params: Promise<{ channel: string; file: string }> },
+) {
+  if (!hasValidDeviceSecret(req)) {
+    return new Response("Unauthorized", { status: 401 });
+  }
+
+  const { channel, file } = await params;
+  const contentType = FILES[file];
+
+  if (!contentType || !CHANNEL_PATTERN.test(channel)) {
+    return new Response("Not found", { status: 404 });
+  }
+
+  try {
+    const data = await readFile(path.join(FIRMWARE_DIR, channel, file));
+    return new Response(data, {
+      status: 200,
+      headers: {
+        "Content-Type": contentType,
+        "Content-Length": String(data.length),
+        "Cache-Control": "no-store",
+      },
+    });
+  } catch {
+    return new Response("Not found", { status: 404 });
+  }
+}
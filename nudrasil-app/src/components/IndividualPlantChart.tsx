@@ -12,7 +12,7 @@ import {
   SensorReading,
   CalibrationData,
 } from "@/models/SensorTypes";
-import { calculateMoisturePercent } from "@/utils/sensorUtils";
+import { moisturePercentForReading } from "@/utils/sensorUtils";
 import { TimePeriod } from "@/utils/sensorDataUtils";
 import { getPlantZonesForType } from "@/config/plantZones";
 
@@ -173,11 +173,7 @@ function processSoilMoistureData(
       return {
         time: dt.toFormat("hh:mm a"),
         timestamp: dt.toISO() || entry.readingTime,
-        moisture: calculateMoisturePercent(
-          entry.value,
-          calData.min,
-          calData.max,
-        ),
+        moisture: moisturePercentForReading(entry, calData),
       };
     })
     .sort(
@@ -26,7 +26,7 @@ import {
   TimePeriod,
   processSensorDataForTimePeriod,
 } from "@/utils/sensorDataUtils";
-import { calculateMoisturePercent } from "@/utils/sensorUtils";
+import { moisturePercentForReading } from "@/utils/sensorUtils";
 import { useBreakpointDown } from "@/hooks/useBreakpoint";
 import { PlantZones } from "@/config/plantZones";
 
@@ -150,8 +150,19 @@ export function SensorChart({
   const processedData = useMemo(() => {
     if (rawSensorData && rawSensorData.length > 0) {
       try {
+        const isMoisture = !!calibrationData && lines[0]?.key === "moisture";
+
+        // Convert to moisture % up front so board-calibrated values survive aggregation
+        const sourceData =
+          isMoisture && calibrationData
+            ? rawSensorData.map((reading) => ({
+                value: moisturePercentForReading(reading, calibrationData),
+                readingTime: reading.readingTime,
+              }))
+            : rawSensorData;
+
         const processedSensorData = processSensorDataForTimePeriod(
-          rawSensorData,
+          sourceData,
           selectedTimePeriod,
         );
 
@@ -161,13 +172,11 @@ export function SensorChart({
             time: sensorReading.readingTime,
           };
 
-          if (calibrationData && lines[0]?.key === "moisture") {
-            const moistureValue = calculateMoisturePercent(
-              sensorReading.value,
-              calibrationData.min,
-              calibrationData.max,
-            );
-            return { ...chartPoint, moisture: moistureValue };
+          if (isMoisture) {
+            return {
+              ...chartPoint,
+              moisture: Math.round(sensorReading.value),
+            };
           } else {
             const key = lines[0]?.key || "value";
             return { ...chartPoint, [key]: sensorReading.value };
@@ -1,6 +1,8 @@
 export interface SensorReading {
   value: number;
   readingTime: string;
+  // Moisture % converted on the board; absent for older readings and non-moisture sensors
+  calibratedValue?: number | null;
 }
 
 export interface CalibrationData {
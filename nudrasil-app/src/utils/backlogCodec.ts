@@ -0,0 +1,239 @@
+/**
+ * Decoder for the bulk backlog chunks boards send to /api/sensor/bulk
+ * Mirrors firmware/esp-dht22-sensor/lib/nudrasil_core/src/reading_backlog.h and lzss.h
+ */
+
+const HEADER_SIZE = 16;
+// Version 3 added per-reading calibration presence (block flag 0x02)
+const MIN_CHUNK_VERSION = 2;
+const CHUNK_VERSION = 3;
+const FLAG_COMPRESSED = 0x01;
+const BLOCK_CALIBRATED = 0x01;
+const BLOCK_PARTIAL_CALIBRATION = 0x02;
+const LZSS_WINDOW_BITS = 8;
+const LZSS_LOOKAHEAD_BITS = 4;
+
+export interface BacklogReading {
+  seq: number;
+  ageMs: number;
+  value: number;
+  calibrated: number | null;
+}
+
+export interface BacklogSensorBlock {
+  sensor: string;
+  readings: BacklogReading[];
+}
+
+export interface BacklogChunk {
+  deviceId: string;
+  bootId: number;
+  firstSeq: number;
+  count: number;
+  blocks: BacklogSensorBlock[];
+}
+
+export class BacklogDecodeError extends Error {}
+
+/**
+ * LZSS in heatshrink's bitstream format (window 2^8, lookahead 2^4)
+ */
+export function lzssDecompress(input: Uint8Array, expectedLength: number) {
+  const out = new Uint8Array(expectedLength);
+  const totalBits = input.length * 8;
+  let bitPos = 0;
+  let n = 0;
+
+  const read = (bits: number): number | null => {
+    if (bitPos + bits > totalBits) {
+      return null;
+    }
+    let value = 0;
+    for (let i = 0; i < bits; i++) {
+      const bit = (input[bitPos >> 3] >> (7 - (bitPos & 7))) & 1;
+      value = (value << 1) | bit;
+      bitPos++;
+    }
+    return value;
+  };
+
+  // Trailing pad bits never form a whole record
+  for (let tag = read(1); tag !== null; tag = read(1)) {
+    if (tag === 1) {
+      const literal = read(8);
+      if (literal === null) {
+        break;
+      }
+      if (n >= expectedLength) {
+        throw new BacklogDecodeError("Compressed body longer than declared");
+      }
+      out[n++] = literal;
+      continue;
+    }
+
+    const index = read(LZSS_WINDOW_BITS);
+    const count = read(LZSS_LOOKAHEAD_BITS);
+    if (index === null || count === null) {
+      break;
+    }
+    const distance = index + 1;
+    if (distance > n || n + count + 1 > expectedLength) {
+      throw new BacklogDecodeError("Invalid back-reference");
+    }
+    for (let k = 0; k <= count; k++, n++) {
+      out[n] = out[n - distance];
+    }
+  }
+
+  if (n !== expectedLength) {
+    throw new BacklogDecodeError("Compressed body shorter than declared");
+  }
+  return out;
+}
+
+class ByteReader {
+  private pos = 0;
+
+  constructor(private readonly bytes: Uint8Array) {}
+
+  byte(): number {
+    if (this.pos >= this.bytes.length) {
+      throw new BacklogDecodeError("Unexpected end of chunk");
+    }
+    return this.bytes[this.pos++];
+  }
+
+  varint(): number {
+    let result = 0;
+    for (let shift = 0; shift < 35; shift += 7) {
+      const b = this.byte();
+      result += (b & 0x7f) * 2 ** shift;
+      if ((b & 0x80) === 0) {
+        return result;
+      }
+    }
+    throw new BacklogDecodeError("Varint too long");
+  }
+
+  zigzag(): number {
+    const v = this.varint();
+    return v % 2 === 0 ? v / 2 : -(v + 1) / 2;
+  }
+
+  text(length: number): string {
+    if (this.pos + length > this.bytes.length) {
+      throw new BacklogDecodeError("Unexpected end of chunk");
+    }
+    const s = new TextDecoder().decode(
+      this.bytes.subarray(this.pos, this.pos + length),
+    );
+    this.pos += length;
+    return s;
+  }
+
+  get done() {
+    return this.pos === this.bytes.length;
+  }
+}
+
+/**
+ * Decodes one chunk. Ages are relative to when the board built the chunk (about when it arrives)
+ */
+export function decodeBacklogChunk(data: Uint8Array): BacklogChunk {
+  if (data.length < HEADER_SIZE || data[0] !== 0x4e || data[1] !== 0x42) {
+    throw new BacklogDecodeError("Not a backlog chunk");
+  }
+  if (data[2] < MIN_CHUNK_VERSION || data[2] > CHUNK_VERSION) {
+    throw new BacklogDecodeError(`Unsupported chunk version ${data[2]}`);
+  }
+
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+  const flags = data[3];
+  const bootId = view.getUint32(4, true);
+  const firstSeq = view.getUint32(8, true);
+  const count = view.getUint16(12, true);
+  const rawLength = view.getUint16(14, true);
+
+  const payload = data.subarray(HEADER_SIZE);
+  const body =
+    flags & FLAG_COMPRESSED ? lzssDecompress(payload, rawLength) : payload;
+  if (body.length !== rawLength) {
+    throw new BacklogDecodeError("Body length does not match header");
+  }
+
+  const reader = new ByteReader(body);
+  const deviceId = reader.text(reader.varint());
+  const blocks: BacklogSensorBlock[] = [];
+  let total = 0;
+
+  const blockCount = reader.varint();
+  for (let b = 0; b < blockCount; b++) {
+    const sensor = reader.text(reader.varint());
+    const n = reader.varint();
+    const blockFlags = reader.byte();
+    const hasCalibrated = (blockFlags & BLOCK_CALIBRATED) !== 0;
+    const partial = (blockFlags & BLOCK_PARTIAL_CALIBRATION) !== 0;
+
+    // Oldest age, then delta-of-delta of the timestamps (seconds)
+    const agesSec = [reader.varint()];
+    let delta = 0;
+    for (let i = 1; i < n; i++) {
+      delta += reader.zigzag();
+      agesSec.push(agesSec[i - 1] - delta);
+    }
+
+    // Per-device sequence numbers (uint32, wrapping)
+    const seqs: number[] = [];
+    let seq = 0;
+    for (let i = 0; i < n; i++) {
+      seq = (seq + reader.zigzag()) >>> 0;
+      seqs.push(seq);
+    }
+
+    const values: number[] = [];
+    let value = 0;
+    for (let i = 0; i < n; i++) {
+      value += reader.zigzag();
+      values.push(value / 100);
+    }
+
+    // Bitmap of which readings have a calibrated value, LSB first
+    const present: boolean[] = [];
+    if (partial) {
+      for (let i = 0; i < n; i += 8) {
+        const bits = reader.byte();
+        for (let k = 0; k < 8 && i + k < n; k++) {
+          present.push((bits & (1 << k)) !== 0);
+        }
+      }
+    }
+
+    const calibrated: (number | null)[] = [];
+    let cal = 0;
+    for (let i = 0; i < n; i++) {
+      if (hasCalibrated && (!partial || present[i])) {
+        cal += reader.zigzag();
+        calibrated.push(cal / 100);
+      } else {
+        calibrated.push(null);
+      }
+    }
+
+    blocks.push({
+      sensor,
+      readings: values.map((v, i) => ({
+        seq: seqs[i],
+        ageMs: Math.max(agesSec[i], 0) * 1000,
+        value: v,
+        calibrated: calibrated[i],
+      })),
+    });
+    total += n;
+  }
+
+  if (total !== count || !reader.done) {
+    throw new BacklogDecodeError("Reading count does not match header");
+  }
+
+  return { deviceId, bootId, firstSeq, count, blocks };
+}
@@ -0,0 +1,27 @@
+import { db } from "@/lib/db";
+import { boards } from "@root/drizzle/schema";
+import { eq, and, not } from "drizzle-orm";
+
+/**
+ * Records the address a board posted from (first x-forwarded-for hop) as its
+ * lastKnownIp, clearing it from any other board that had it
+ */
+export async function updateBoardIp(
+  req: Request,
+  boardId: number,
+): Promise<void> {
+  const ip =
+    req.headers.get("x-forwarded-for")?.split(",")[0]?.trim() ?? "0.0.0.0";
+
+  // Clear the IP from any other board that has it
+  await db
+    .update(boards)
+    .set({ lastKnownIp: null })
+    .where(and(eq(boards.lastKnownIp, ip), not(eq(boards.id, boardId))));
+
+  // Set the IP on the current board
+  await db
+    .update(boards)
+    .set({ lastKnownIp: ip })
+    .where(eq(boards.id, boardId));
+}
@@ -0,0 +1,9 @@
+/**
+ * Checks the device secret boards send as the raw Authorization header
+ * (DEVICE_SECRET in the firmware, ADMIN_SECRET here)
+ */
+export function hasValidDeviceSecret(req: Request): boolean {
+  const deviceSecret = process.env.ADMIN_SECRET;
+  const authHeader = req.headers.get("authorization");
+  return !!deviceSecret && authHeader === deviceSecret;
+}
@@ -1,3 +1,5 @@
+import { CalibrationData, SensorReading } from "@/models/SensorTypes";
+
 /**
  * Calculates moisture percentage from raw value based on sensor calibration data
  * High Value = Dry, Low Value = Wet
@@ -8,5 +10,25 @@ export function calculateMoisturePercent(
   soilMax: number,
 ): number {
   const clamped = Math.max(Math.min(rawValue, soilMax), soilMin);
-  return Math.round(((soilMax - clamped) / (soilMax - soilMin)) * 100);
+  // Multiply before dividing so exact halves stay exact (23 / 40 * 100 is 57.49999...)
+  // Boards compute the same rounding in countsToMoistureQ8()
+  return Math.round(((soilMax - clamped) * 100) / (soilMax - soilMin));
+}
+
+/**
+ * Moisture percentage for a reading, preferring the value the board already calibrated
+ * Falls back to converting the raw value for older readings
+ */
+export function moisturePercentForReading(
+  reading: SensorReading,
+  calibration: CalibrationData,
+): number {
+  if (typeof reading.calibratedValue === "number") {
+    return reading.calibratedValue;
+  }
+  return calculateMoisturePercent(
+    reading.value,
+    calibration.min,
+    calibration.max,
+  );
 }